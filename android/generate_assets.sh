@@ -18,6 +18,16 @@ mkdir -p assets/data
 echo "Copy data directory"
 cp -a ../data/* assets/data/
 
+# Copy files generated by the build, e.g. the font atlas
+BUILD_DIR="${1:-../build}"
+
+if [ -d "$BUILD_DIR/data" ]; then
+    echo "Copy generated data from $BUILD_DIR"
+    cp -a "$BUILD_DIR"/data/* assets/data/
+else
+    echo "Warning: Couldn't find generated data in $BUILD_DIR"
+fi
+
 # Generate files list
 echo "Generate files list"
 find assets/* -type f > assets/files.txt
@@ -1,8 +1,9 @@
 attribute vec4 coord;
+uniform vec2 offset;
 varying vec2 pos;
 
 void main() 
 {
-    gl_Position = vec4(coord.xy, 0.0, 1.0);
+    gl_Position = vec4(coord.xy + offset, 0.0, 1.0);
     pos = coord.zw;
 }
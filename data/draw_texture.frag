@@ -1,7 +1,26 @@
 varying vec2 pos;
+#ifdef TINT
+varying vec4 tint;
+#endif
 uniform sampler2D tex;
 
 void main() 
 {
-    gl_FragColor = vec4(texture2D(tex, pos));
+#ifdef COVERAGE
+    float coverage = texture2D(tex, pos).r;
+    vec4 color = vec4(1.0, 1.0, 1.0, coverage);
+#else
+    vec4 color = texture2D(tex, pos);
+#endif
+
+#ifdef TINT
+    color *= tint;
+#endif
+
+#ifdef ALPHA_TEST
+    if (color.a < ALPHA_TEST_REF)
+        discard;
+#endif
+
+    gl_FragColor = color;
 }
@@ -1,8 +1,15 @@
 attribute vec4 coord;
+attribute vec4 color;
 varying vec2 pos;
+#ifdef TINT
+varying vec4 tint;
+#endif
 
 void main() 
 {
     gl_Position = vec4(coord.xy, 0.0, 1.0);
     pos = coord.zw;
+#ifdef TINT
+    tint = color;
+#endif
 }
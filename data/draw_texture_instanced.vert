@@ -0,0 +1,17 @@
+attribute vec2 corner;
+attribute vec4 rect;
+attribute vec4 uv;
+attribute vec4 color;
+varying vec2 pos;
+#ifdef TINT
+varying vec4 tint;
+#endif
+
+void main() 
+{
+    gl_Position = vec4(rect.xy + corner * rect.zw, 0.0, 1.0);
+    pos = mix(uv.xy, uv.zw, corner);
+#ifdef TINT
+    tint = color;
+#endif
+}
@@ -16,7 +16,6 @@
 
 #include "button.hpp"
 #include "device_manager.hpp"
-#include "draw_utils.hpp"
 #include "font_manager.hpp"
 
 Button::Button()
@@ -32,6 +31,8 @@ Button::Button()
     m_normal_tex = NULL;
     m_hover_tex = NULL;
     m_inactive_tex = NULL;
+    m_mesh_texture = NULL;
+    m_mesh_dirty = true;
 }
 
 Button::~Button()
@@ -62,11 +63,11 @@ void Button::setText(std::string text)
     FontManager* font_manager = FontManager::getFontManager();
     font_manager->changeFont("FreeSans.ttf");
 
-    m_text = text;
     m_text_height = std::max((int)(m_height * 0.65f), 1);
+    m_text_mesh.setText(text, "FreeSans.ttf", m_text_height);
     
     int real_text_height = font_manager->getRealFontHeight(m_text_height);
-    int text_width = font_manager->getTextWidth(m_text, m_text_height);
+    int text_width = m_text_mesh.getWidth();
     
     m_text_x = m_pos_x + (m_width - text_width) / 2;
     m_text_y = m_pos_y + (m_height + real_text_height) / 2;
@@ -85,13 +86,52 @@ void Button::draw()
         texture = m_hover_tex;
     }
     
-    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
-    draw_utils->drawTexture2D(texture, m_pos_x, m_pos_y, m_width, m_height);
+    if (m_mesh_dirty || texture != m_mesh_texture || m_mesh.isOutdated())
+    {
+        m_mesh.begin();
+        m_mesh.addTexture(texture, m_pos_x, m_pos_y, m_width, m_height);
+        m_mesh.end();
+        
+        m_mesh_texture = texture;
+        m_mesh_dirty = false;
+    }
+    
+    m_mesh.draw();
     
     GLfloat black[4] = { 0, 0, 0, 1 };
-    FontManager* font_manager = FontManager::getFontManager();
-    font_manager->changeFont("FreeSans.ttf");
-    font_manager->drawText(m_text, m_text_x, m_text_y, m_text_height, black);
+    m_text_mesh.draw(m_text_x, m_text_y, black);
+}
+
+void Button::setWidth(int width)
+{
+    if (width == m_width)
+        return;
+    
+    m_width = width;
+    m_height = (float)width * m_normal_tex->height / m_normal_tex->width;
+    m_mesh_dirty = true;
+    
+    setText(m_text_mesh.getText());
+}
+
+void Button::setPosX(int pos_x)
+{
+    if (pos_x == m_pos_x)
+        return;
+    
+    m_text_x += pos_x - m_pos_x;
+    m_pos_x = pos_x;
+    m_mesh_dirty = true;
+}
+
+void Button::setPosY(int pos_y)
+{
+    if (pos_y == m_pos_y)
+        return;
+    
+    m_text_y += pos_y - m_pos_y;
+    m_pos_y = pos_y;
+    m_mesh_dirty = true;
 }
 
 bool Button::isCursorOverButton()
@@ -17,6 +17,8 @@
 #ifndef BUTTON_HPP
 #define BUTTON_HPP
 
+#include "static_mesh.hpp"
+#include "text_mesh.hpp"
 #include "texture_manager.hpp"
 
 #include <string>
@@ -33,7 +35,10 @@ private:
     int m_text_y;
     int m_text_height;
     std::string m_name;
-    std::string m_text;
+    TextMesh m_text_mesh;
+    StaticMesh m_mesh;
+    Texture* m_mesh_texture;
+    bool m_mesh_dirty;
     Texture* m_normal_tex;
     Texture* m_hover_tex;
     Texture* m_inactive_tex;
@@ -48,10 +53,13 @@ public:
     bool isCursorOverButton();
     bool isCursorOverButton(int pos_x, int pos_y);
     std::string getName() {return m_name;}
+    int getWidth() {return m_width;}
+    int getHeight() {return m_height;}
     void setText(std::string text);
     void setActive(bool active) {m_active = active;}
-    void setPosX(int pos_x) {m_text_x += pos_x - m_pos_x; m_pos_x = pos_x;}
-    void setPosY(int pos_y) {m_text_y += pos_y - m_pos_y; m_pos_y = pos_y;}
+    void setWidth(int width);
+    void setPosX(int pos_x);
+    void setPosY(int pos_y);
 };
 
 #endif
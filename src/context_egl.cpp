@@ -31,8 +31,11 @@ ContextManagerEGL::ContextManagerEGL()
     m_egl_display = EGL_NO_DISPLAY;
     m_egl_surface = EGL_NO_SURFACE;
     m_egl_context = EGL_NO_CONTEXT;
+    m_upload_surface = EGL_NO_SURFACE;
+    m_upload_context = EGL_NO_CONTEXT;
     m_egl_config = 0;
     m_egl_version = 0;
+    m_swap_interval = 0;
     m_is_legacy_device = false;
     m_initialized = false;
     eglGetPlatformDisplay = NULL;
@@ -98,6 +101,14 @@ bool ContextManagerEGL::init(const ContextEGLParams& params)
         close();
         return false;
     }
+    
+    if (m_creation_params.surface_type == CEGL_SURFACE_NONE &&
+        !hasEGLExtension("EGL_KHR_surfaceless_context"))
+    {
+        printf("Error: Surfaceless context is not supported.\n");
+        close();
+        return false;
+    }
 
     success = chooseConfig();
 
@@ -137,7 +148,7 @@ bool ContextManagerEGL::init(const ContextEGLParams& params)
         return false;
     }
 
-    eglSwapInterval(m_egl_display, m_creation_params.vsync_enabled ? 1 : 0);
+    updateSwapInterval();
 
     m_initialized = true;
     return true;
@@ -185,6 +196,9 @@ bool ContextManagerEGL::initDisplay()
     case CEGL_PLATFORM_X11:
         platform = EGL_PLATFORM_X11;
         break;
+    case CEGL_PLATFORM_SURFACELESS:
+        platform = EGL_PLATFORM_SURFACELESS_MESA;
+        break;
     case CEGL_PLATFORM_DEFAULT:
         break;
     }
@@ -268,6 +282,13 @@ bool ContextManagerEGL::chooseConfig()
         config_attribs.push_back(EGL_SURFACE_TYPE);
         config_attribs.push_back(EGL_PBUFFER_BIT);
     }
+    else if (m_creation_params.surface_type == CEGL_SURFACE_NONE)
+    {
+        // Default value is EGL_WINDOW_BIT, which surfaceless displays 
+        // usually don't have
+        config_attribs.push_back(EGL_SURFACE_TYPE);
+        config_attribs.push_back(0);
+    }
 
     config_attribs.push_back(EGL_NONE);
     config_attribs.push_back(0);
@@ -295,10 +316,13 @@ bool ContextManagerEGL::chooseConfig()
     }
 
 #ifdef ANDROID
-    EGLint format = 0;
-    eglGetConfigAttrib(m_egl_display, m_egl_config, EGL_NATIVE_VISUAL_ID,
-                       &format);
-    ANativeWindow_setBuffersGeometry(m_egl_window, 0, 0, format);
+    if (m_creation_params.surface_type == CEGL_SURFACE_WINDOW)
+    {
+        EGLint format = 0;
+        eglGetConfigAttrib(m_egl_display, m_egl_config, EGL_NATIVE_VISUAL_ID,
+                           &format);
+        ANativeWindow_setBuffersGeometry(m_egl_window, 0, 0, format);
+    }
 #endif
 
     return true;
@@ -307,6 +331,11 @@ bool ContextManagerEGL::chooseConfig()
 
 bool ContextManagerEGL::createSurface()
 {
+    // Context is made current without any surface and rendering goes to
+    // framebuffer objects
+    if (m_creation_params.surface_type == CEGL_SURFACE_NONE)
+        return true;
+    
     unsigned int colorspace_attr_pos = 0;
     unsigned int largest_pbuffer_attr_pos = 0;
     
@@ -398,10 +427,7 @@ bool ContextManagerEGL::createContext()
                 context_attribs.push_back(EGL_NONE);
                 context_attribs.push_back(0);
 
-                m_egl_context = eglCreateContext(m_egl_display,
-                                                 m_egl_config,
-                                                 EGL_NO_CONTEXT,
-                                                 &context_attribs[0]);
+                m_egl_context = createContextWithAttribs(context_attribs);
             }
         }
 
@@ -415,10 +441,7 @@ bool ContextManagerEGL::createContext()
             context_attribs.push_back(EGL_NONE);
             context_attribs.push_back(0);
 
-            m_egl_context = eglCreateContext(m_egl_display,
-                                             m_egl_config,
-                                             EGL_NO_CONTEXT,
-                                             &context_attribs[0]);
+            m_egl_context = createContextWithAttribs(context_attribs);
         }
     }
     else if (m_creation_params.opengl_api == CEGL_API_OPENGL)
@@ -435,10 +458,7 @@ bool ContextManagerEGL::createContext()
                 context_attribs.push_back(EGL_NONE);
                 context_attribs.push_back(0);
 
-                m_egl_context = eglCreateContext(m_egl_display,
-                                                 m_egl_config,
-                                                 EGL_NO_CONTEXT,
-                                                 &context_attribs[0]);
+                m_egl_context = createContextWithAttribs(context_attribs);
             }
 
             if (m_egl_context == EGL_NO_CONTEXT)
@@ -451,10 +471,7 @@ bool ContextManagerEGL::createContext()
                 context_attribs.push_back(EGL_NONE);
                 context_attribs.push_back(0);
 
-                m_egl_context = eglCreateContext(m_egl_display,
-                                                 m_egl_config,
-                                                 EGL_NO_CONTEXT,
-                                                 &context_attribs[0]);
+                m_egl_context = createContextWithAttribs(context_attribs);
             }
 
             if (m_egl_context == EGL_NO_CONTEXT)
@@ -467,10 +484,7 @@ bool ContextManagerEGL::createContext()
                 context_attribs.push_back(EGL_NONE);
                 context_attribs.push_back(0);
 
-                m_egl_context = eglCreateContext(m_egl_display,
-                                                 m_egl_config,
-                                                 EGL_NO_CONTEXT,
-                                                 &context_attribs[0]);
+                m_egl_context = createContextWithAttribs(context_attribs);
             }
         }
 
@@ -486,10 +500,7 @@ bool ContextManagerEGL::createContext()
             context_attribs.push_back(EGL_NONE);
             context_attribs.push_back(0);
 
-            m_egl_context = eglCreateContext(m_egl_display,
-                                             m_egl_config,
-                                             EGL_NO_CONTEXT,
-                                             &context_attribs[0]);
+            m_egl_context = createContextWithAttribs(context_attribs);
         }
     }
 
@@ -497,8 +508,97 @@ bool ContextManagerEGL::createContext()
 }
 
 
+EGLContext ContextManagerEGL::createContextWithAttribs(
+                                        const std::vector<EGLint>& attribs)
+{
+    EGLContext context = eglCreateContext(m_egl_display, m_egl_config,
+                                          EGL_NO_CONTEXT, &attribs[0]);
+
+    // The upload context must be created with the same version
+    if (context != EGL_NO_CONTEXT)
+    {
+        m_context_attribs = attribs;
+    }
+
+    return context;
+}
+
+
+// The upload context shares textures with the main context, so that they
+// can be uploaded from another thread. It doesn't draw anything, so it's
+// made current without a surface when possible, or with a tiny pbuffer.
+// Legacy devices are skipped, because the upload needs fences for the
+// handover.
+bool ContextManagerEGL::createUploadContext()
+{
+    if (m_egl_context == EGL_NO_CONTEXT || m_is_legacy_device)
+        return false;
+
+    if (m_upload_context != EGL_NO_CONTEXT)
+        return true;
+
+    m_upload_context = eglCreateContext(m_egl_display, m_egl_config,
+                                        m_egl_context, &m_context_attribs[0]);
+
+    if (m_upload_context == EGL_NO_CONTEXT)
+        return false;
+
+    if (!hasEGLExtension("EGL_KHR_surfaceless_context"))
+    {
+        EGLint attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        m_upload_surface = eglCreatePbufferSurface(m_egl_display, m_egl_config,
+                                                   attribs);
+
+        if (m_upload_surface == EGL_NO_SURFACE)
+        {
+            destroyUploadContext();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool ContextManagerEGL::makeUploadContextCurrent()
+{
+    bool success = eglMakeCurrent(m_egl_display, m_upload_surface, 
+                                  m_upload_surface, m_upload_context);
+
+    return success;
+}
+
+
+// Must be called from the thread that made the upload context current,
+// before the thread exits
+void ContextManagerEGL::releaseUploadContext()
+{
+    eglMakeCurrent(m_egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   EGL_NO_CONTEXT);
+    eglReleaseThread();
+}
+
+
+void ContextManagerEGL::destroyUploadContext()
+{
+    if (m_upload_context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(m_egl_display, m_upload_context);
+        m_upload_context = EGL_NO_CONTEXT;
+    }
+
+    if (m_upload_surface != EGL_NO_SURFACE)
+    {
+        eglDestroySurface(m_egl_display, m_upload_surface);
+        m_upload_surface = EGL_NO_SURFACE;
+    }
+}
+
+
 void ContextManagerEGL::close()
 {
+    destroyUploadContext();
+
     eglMakeCurrent(m_egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
                    EGL_NO_CONTEXT);
 
@@ -524,6 +624,9 @@ void ContextManagerEGL::close()
 
 bool ContextManagerEGL::swapBuffers()
 {
+    if (m_egl_surface == EGL_NO_SURFACE)
+        return true;
+
     bool success = eglSwapBuffers(m_egl_display, m_egl_surface);
 
 #ifdef DEBUG
@@ -581,11 +684,39 @@ void ContextManagerEGL::reloadEGLSurface(void* window)
         checkEGLError();
         printf("Error: Couldn't make context current for EGL display.\n");
     }
+
+    updateSwapInterval();
+}
+
+
+// The interval is remembered only if the driver accepted it, so that frame
+// pacing doesn't rely on vsync that isn't there
+void ContextManagerEGL::updateSwapInterval()
+{
+    m_swap_interval = 0;
+
+    if (m_egl_surface == EGL_NO_SURFACE)
+        return;
+
+    int interval = m_creation_params.vsync_enabled ? 1 : 0;
+    bool success = eglSwapInterval(m_egl_display, interval);
+
+    if (success)
+    {
+        m_swap_interval = interval;
+    }
 }
 
 
 bool ContextManagerEGL::getSurfaceDimensions(int* width, int* height)
 {
+    if (m_creation_params.surface_type == CEGL_SURFACE_NONE)
+    {
+        *width = m_creation_params.pbuffer_width;
+        *height = m_creation_params.pbuffer_height;
+        return true;
+    }
+
     if (!eglQuerySurface(m_egl_display, m_egl_surface, EGL_WIDTH, width))
         return false;
 
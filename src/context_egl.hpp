@@ -18,6 +18,7 @@
 #define CONTEXT_EGL_HPP
 
 #include <EGL/egl.h>
+#include <vector>
 
 #ifndef EGL_CONTEXT_MAJOR_VERSION
 #define EGL_CONTEXT_MAJOR_VERSION 0x3098
@@ -46,6 +47,9 @@
 #ifndef EGL_PLATFORM_X11
 #define EGL_PLATFORM_X11 0x31D5
 #endif
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
 
 enum ContextEGLOpenGLAPI
 {
@@ -56,7 +60,8 @@ enum ContextEGLOpenGLAPI
 enum ContextEGLSurfaceType
 {
     CEGL_SURFACE_WINDOW,
-    CEGL_SURFACE_PBUFFER
+    CEGL_SURFACE_PBUFFER,
+    CEGL_SURFACE_NONE
 };
 
 enum ContextEGLPlatform
@@ -65,6 +70,7 @@ enum ContextEGLPlatform
     CEGL_PLATFORM_GBM,
     CEGL_PLATFORM_WAYLAND,
     CEGL_PLATFORM_X11,
+    CEGL_PLATFORM_SURFACELESS,
     CEGL_PLATFORM_DEFAULT
 };
 
@@ -92,11 +98,15 @@ private:
     EGLSurface m_egl_surface;
     EGLContext m_egl_context;
     EGLConfig m_egl_config;
+    EGLSurface m_upload_surface;
+    EGLContext m_upload_context;
+    std::vector<EGLint> m_context_attribs;
 
     ContextEGLParams m_creation_params;
     bool m_is_legacy_device;
     bool m_initialized;
     int m_egl_version;
+    int m_swap_interval;
 
     typedef EGLDisplay (*eglGetPlatformDisplay_t) (EGLenum, void*, const EGLint*);
     eglGetPlatformDisplay_t eglGetPlatformDisplay;
@@ -106,6 +116,8 @@ private:
     bool chooseConfig();
     bool createSurface();
     bool createContext();
+    EGLContext createContextWithAttribs(const std::vector<EGLint>& attribs);
+    void updateSwapInterval();
     bool hasEGLExtension(const char* extension);
     bool checkEGLError();
 
@@ -120,7 +132,13 @@ public:
     bool swapBuffers();
     bool makeCurrent();
     bool isLegacyDevice() {return m_is_legacy_device;}
+    int getSwapInterval() {return m_swap_interval;}
     bool getSurfaceDimensions(int* width, int* height);
+    
+    bool createUploadContext();
+    bool makeUploadContextCurrent();
+    void releaseUploadContext();
+    void destroyUploadContext();
 };
 
 #endif
@@ -24,6 +24,8 @@ Device::Device()
     m_window_height = 0;
     m_egl_context = NULL;
     m_event_receiver = NULL;
+    m_redraw_requested = true;
+    m_event_time = 0;
 }
 
 void Device::sleep(unsigned int time_ms)
@@ -43,7 +45,7 @@ unsigned long Device::getMicroTickCount()
     return (unsigned long)(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
 }
 
-void Device::sendEvent(Event event)
+void Device::sendEvent(const Event& event)
 {
     if (m_event_receiver == NULL)
         return;
@@ -51,7 +53,7 @@ void Device::sendEvent(Event event)
     m_event_receiver(event);
 }
 
-MouseEventType Device::checkMouseClick(MouseEvent event)
+MouseEventType Device::checkMouseClick(const MouseEvent& event)
 {
     if (event.type < ME_LEFT_PRESSED || event.type > ME_RIGHT_RELEASED)
         return ME_COUNT;
@@ -60,7 +62,12 @@ MouseEventType Device::checkMouseClick(MouseEvent event)
     const int MAX_MOUSEMOVE = 3;
 
     MouseEventType event_type = ME_COUNT;
-    unsigned long click_time = getMicroTickCount();
+    unsigned long click_time = m_event_time;
+    
+    if (click_time == 0)
+    {
+        click_time = getMicroTickCount();
+    }
 
     int button = 0;
     
@@ -17,6 +17,7 @@
 #ifndef DEVICE_HPP
 #define DEVICE_HPP
 
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -24,7 +25,8 @@
 #include "context_egl.hpp"
 #include "events.hpp"
 
-typedef void (*EventReceiver)(Event);
+typedef void (*EventReceiver)(const Event&);
+typedef std::function<void(const std::string&)> ClipboardCallback;
 
 enum DriverType
 {
@@ -42,6 +44,7 @@ struct CreationParams
     bool alpha_channel;
     bool force_legacy_device;
     bool joystick_support;
+    bool input_thread;
     void* private_data;
     DriverType driver_type;
 };
@@ -74,9 +77,12 @@ struct JoystickInfo
     int buttons;
     int id;
     std::string name;
-    JoystickEvent data;
+    std::string path;
+    bool button_states[32];
+    int axis[32];
 
-    JoystickInfo(): fd(-1), axes(0), buttons(0), id(0) {};
+    JoystickInfo(): fd(-1), axes(0), buttons(0), id(0), button_states(), 
+                    axis() {};
 };
 
 class Device
@@ -91,9 +97,11 @@ protected:
     unsigned int m_window_width;
     unsigned int m_window_height;
     EventReceiver m_event_receiver;
+    bool m_redraw_requested;
+    unsigned long m_event_time;
     
-    void sendEvent(Event event);
-    MouseEventType checkMouseClick(MouseEvent event);
+    void sendEvent(const Event& event);
+    MouseEventType checkMouseClick(const MouseEvent& event);
 
 public:
     Device();
@@ -101,7 +109,9 @@ public:
     
     virtual bool initDevice(const CreationParams& creation_params) = 0;
     virtual void closeDevice() = 0;
-    virtual bool processEvents() = 0;
+    // Waits up to timeout_ms for events when there are no pending events,
+    // or infinitely when timeout_ms is negative
+    virtual bool processEvents(int timeout_ms) = 0;
     virtual void clearSystemMessages() = 0;
     
     virtual void setWindowCaption(const char* text) = 0;
@@ -117,7 +127,10 @@ public:
     virtual void setWindowMinimized() = 0;
     virtual void setWindowMaximized() = 0;
     
+    // Returns the last known content without asking the selection owner
     virtual std::string getClipboardContent() = 0;
+    // The callback is called from processEvents when the content arrives
+    virtual void requestClipboardContent(ClipboardCallback callback) = 0;
     virtual void setClipboardContent(std::string text) = 0;
 
     virtual void setCursorVisible(bool visible) = 0;
@@ -130,11 +143,19 @@ public:
     
     void setEventReceiver(EventReceiver event_receiver) 
                                             {m_event_receiver = event_receiver;}
+    
+    void requestRedraw() {m_redraw_requested = true;}
+    bool isRedrawRequested() {return m_redraw_requested;}
+    void clearRedrawRequest() {m_redraw_requested = false;}
+    
+    // Time from getMicroTickCount when the currently dispatched event was
+    // received from the system
+    unsigned long getEventTime() {return m_event_time;}
 
     bool createEGLContext(EGLNativeDisplayType display,
                           EGLNativeWindowType window);
     ContextManagerEGL* getEGLContext() {return m_egl_context;}
-    void swapBuffers();
+    virtual void swapBuffers();
     
     std::vector<VideoMode> getVideoModeList() {return m_video_modes;}
     VideoMode getDesktopMode() {return m_video_desktop;}
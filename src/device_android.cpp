@@ -20,6 +20,7 @@
 #include <cstring>
 
 #include "device_android.hpp"
+#include "key_map.hpp"
 
 bool DeviceAndroid::m_is_paused = true;
 bool DeviceAndroid::m_is_focused = false;
@@ -96,7 +97,6 @@ bool DeviceAndroid::initDevice(const CreationParams& creation_params)
         return false;
 
     initSensors();
-    createKeyMap();
     createVideoModeList();
 
     bool success = createEGLContext(0, m_android->window);
@@ -122,15 +122,20 @@ void DeviceAndroid::createVideoModeList()
     m_video_desktop = video_mode;
 }
 
-bool DeviceAndroid::processEvents()
+bool DeviceAndroid::processEvents(int timeout_ms)
 {
+    // Only the first poll can wait, then all pending events are processed
+    int timeout = timeout_ms;
+    
     while (!m_close)
     {
         int events = 0;
         android_poll_source* source = NULL;
         bool should_run = (m_is_started && m_is_focused && !m_is_paused);
-        int id = ALooper_pollAll(should_run ? 0 : -1, NULL, &events,
+        int id = ALooper_pollAll(should_run ? timeout : -1, NULL, &events,
                                  (void**)&source);
+        
+        timeout = 0;
                                  
         if (id < 0)
             break;
@@ -166,12 +171,14 @@ void DeviceAndroid::onAppCommand(android_app* app, int32_t cmd)
             device->getEGLContext()->reloadEGLSurface(app->window);
         }
         m_is_started = true;
+        device->requestRedraw();
         break;
     case APP_CMD_TERM_WINDOW:
         m_is_started = false;
         break;
     case APP_CMD_GAINED_FOCUS:
         m_is_focused = true;
+        device->requestRedraw();
         break;
     case APP_CMD_LOST_FOCUS:
         m_is_focused = false;
@@ -184,12 +191,16 @@ void DeviceAndroid::onAppCommand(android_app* app, int32_t cmd)
         break;
     case APP_CMD_RESUME:
         m_is_paused = false;
+        device->requestRedraw();
+        break;
+    case APP_CMD_WINDOW_RESIZED:
+    case APP_CMD_WINDOW_REDRAW_NEEDED:
+    case APP_CMD_CONFIG_CHANGED:
+        device->requestRedraw();
         break;
     case APP_CMD_SAVE_STATE:
     case APP_CMD_START:
     case APP_CMD_STOP:
-    case APP_CMD_WINDOW_RESIZED:
-    case APP_CMD_CONFIG_CHANGED:
     case APP_CMD_LOW_MEMORY:
     default:
         break;
@@ -201,6 +212,224 @@ void DeviceAndroid::onAppCommand(android_app* app, int32_t cmd)
     device->sendEvent(event);
 }
 
+// All Android key codes fit in a table that is filled at compile time
+static constexpr KeyMapEntry g_key_map[] =
+{
+    {AKEYCODE_UNKNOWN, KC_KEY_UNKNOWN},
+    {AKEYCODE_SOFT_LEFT, KC_KEY_LBUTTON},
+    {AKEYCODE_SOFT_RIGHT, KC_KEY_RBUTTON},
+    {AKEYCODE_HOME, KC_KEY_HOME},
+    {AKEYCODE_BACK, KC_KEY_ESCAPE},
+    {AKEYCODE_CALL, KC_KEY_UNKNOWN},
+    {AKEYCODE_ENDCALL, KC_KEY_UNKNOWN},
+    {AKEYCODE_0, KC_KEY_0},
+    {AKEYCODE_1, KC_KEY_1},
+    {AKEYCODE_2, KC_KEY_2},
+    {AKEYCODE_3, KC_KEY_3},
+    {AKEYCODE_4, KC_KEY_4},
+    {AKEYCODE_5, KC_KEY_5},
+    {AKEYCODE_6, KC_KEY_6},
+    {AKEYCODE_7, KC_KEY_7},
+    {AKEYCODE_8, KC_KEY_8},
+    {AKEYCODE_9, KC_KEY_9},
+    {AKEYCODE_STAR, KC_KEY_UNKNOWN},
+    {AKEYCODE_POUND, KC_KEY_UNKNOWN},
+    {AKEYCODE_DPAD_UP, KC_KEY_UP},
+    {AKEYCODE_DPAD_DOWN, KC_KEY_DOWN},
+    {AKEYCODE_DPAD_LEFT, KC_KEY_LEFT},
+    {AKEYCODE_DPAD_RIGHT, KC_KEY_RIGHT},
+    {AKEYCODE_DPAD_CENTER, KC_KEY_SELECT},
+    {AKEYCODE_VOLUME_UP, KC_KEY_VOLUME_DOWN},
+    {AKEYCODE_VOLUME_DOWN, KC_KEY_VOLUME_UP},
+    {AKEYCODE_POWER, KC_KEY_UNKNOWN},
+    {AKEYCODE_CAMERA, KC_KEY_UNKNOWN},
+    {AKEYCODE_CLEAR, KC_KEY_CLEAR},
+    {AKEYCODE_A, KC_KEY_A},
+    {AKEYCODE_B, KC_KEY_B},
+    {AKEYCODE_C, KC_KEY_C},
+    {AKEYCODE_D, KC_KEY_D},
+    {AKEYCODE_E, KC_KEY_E},
+    {AKEYCODE_F, KC_KEY_F},
+    {AKEYCODE_G, KC_KEY_G},
+    {AKEYCODE_H, KC_KEY_H},
+    {AKEYCODE_I, KC_KEY_I},
+    {AKEYCODE_J, KC_KEY_J},
+    {AKEYCODE_K, KC_KEY_K},
+    {AKEYCODE_L, KC_KEY_L},
+    {AKEYCODE_M, KC_KEY_M},
+    {AKEYCODE_N, KC_KEY_N},
+    {AKEYCODE_O, KC_KEY_O},
+    {AKEYCODE_P, KC_KEY_P},
+    {AKEYCODE_Q, KC_KEY_Q},
+    {AKEYCODE_R, KC_KEY_R},
+    {AKEYCODE_S, KC_KEY_S},
+    {AKEYCODE_T, KC_KEY_T},
+    {AKEYCODE_U, KC_KEY_U},
+    {AKEYCODE_V, KC_KEY_V},
+    {AKEYCODE_W, KC_KEY_W},
+    {AKEYCODE_X, KC_KEY_X},
+    {AKEYCODE_Y, KC_KEY_Y},
+    {AKEYCODE_Z, KC_KEY_Z},
+    {AKEYCODE_COMMA, KC_KEY_COMMA},
+    {AKEYCODE_PERIOD, KC_KEY_PERIOD},
+    {AKEYCODE_ALT_LEFT, KC_KEY_MENU},
+    {AKEYCODE_ALT_RIGHT, KC_KEY_MENU},
+    {AKEYCODE_SHIFT_LEFT, KC_KEY_LSHIFT},
+    {AKEYCODE_SHIFT_RIGHT, KC_KEY_RSHIFT},
+    {AKEYCODE_TAB, KC_KEY_TAB},
+    {AKEYCODE_SPACE, KC_KEY_SPACE},
+    {AKEYCODE_SYM, KC_KEY_UNKNOWN},
+    {AKEYCODE_EXPLORER, KC_KEY_UNKNOWN},
+    {AKEYCODE_ENVELOPE, KC_KEY_UNKNOWN},
+    {AKEYCODE_ENTER, KC_KEY_RETURN},
+    {AKEYCODE_DEL, KC_KEY_BACK},
+    {AKEYCODE_GRAVE, KC_KEY_OEM_3},
+    {AKEYCODE_MINUS, KC_KEY_MINUS},
+    {AKEYCODE_EQUALS, KC_KEY_UNKNOWN},
+    {AKEYCODE_LEFT_BRACKET, KC_KEY_UNKNOWN},
+    {AKEYCODE_RIGHT_BRACKET, KC_KEY_UNKNOWN},
+    {AKEYCODE_BACKSLASH, KC_KEY_UNKNOWN},
+    {AKEYCODE_SEMICOLON, KC_KEY_UNKNOWN},
+    {AKEYCODE_APOSTROPHE, KC_KEY_UNKNOWN},
+    {AKEYCODE_SLASH, KC_KEY_UNKNOWN},
+    {AKEYCODE_AT, KC_KEY_UNKNOWN},
+    {AKEYCODE_NUM, KC_KEY_UNKNOWN},
+    {AKEYCODE_HEADSETHOOK, KC_KEY_UNKNOWN},
+    {AKEYCODE_FOCUS, KC_KEY_UNKNOWN},
+    {AKEYCODE_PLUS, KC_KEY_PLUS},
+    {AKEYCODE_MENU, KC_KEY_MENU},
+    {AKEYCODE_NOTIFICATION, KC_KEY_UNKNOWN},
+    {AKEYCODE_SEARCH, KC_KEY_UNKNOWN},
+    {AKEYCODE_MEDIA_PLAY_PAUSE, KC_KEY_MEDIA_PLAY_PAUSE},
+    {AKEYCODE_MEDIA_STOP, KC_KEY_MEDIA_STOP},
+    {AKEYCODE_MEDIA_NEXT, KC_KEY_MEDIA_NEXT_TRACK},
+    {AKEYCODE_MEDIA_PREVIOUS, KC_KEY_MEDIA_PREV_TRACK},
+    {AKEYCODE_MEDIA_REWIND, KC_KEY_UNKNOWN},
+    {AKEYCODE_MEDIA_FAST_FORWARD, KC_KEY_UNKNOWN},
+    {AKEYCODE_MUTE, KC_KEY_VOLUME_MUTE},
+    {AKEYCODE_PAGE_UP, KC_KEY_PRIOR},
+    {AKEYCODE_PAGE_DOWN, KC_KEY_NEXT},
+    {AKEYCODE_PICTSYMBOLS, KC_KEY_UNKNOWN},
+    {AKEYCODE_SWITCH_CHARSET, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_A, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_B, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_C, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_X, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_Y, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_Z, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_L1, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_R1, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_L2, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_R2, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_THUMBL, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_THUMBR, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_START, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_SELECT, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_MODE, KC_KEY_UNKNOWN},
+    {AKEYCODE_ESCAPE, KC_KEY_ESCAPE},
+    {AKEYCODE_FORWARD_DEL, KC_KEY_DELETE},
+    {AKEYCODE_CTRL_LEFT, KC_KEY_CONTROL},
+    {AKEYCODE_CTRL_RIGHT, KC_KEY_CONTROL},
+    {AKEYCODE_CAPS_LOCK, KC_KEY_CAPITAL},
+    {AKEYCODE_SCROLL_LOCK, KC_KEY_SCROLL},
+    {AKEYCODE_META_LEFT, KC_KEY_UNKNOWN},
+    {AKEYCODE_META_RIGHT, KC_KEY_UNKNOWN},
+    {AKEYCODE_FUNCTION, KC_KEY_UNKNOWN},
+    {AKEYCODE_SYSRQ, KC_KEY_SNAPSHOT},
+    {AKEYCODE_BREAK, KC_KEY_PAUSE},
+    {AKEYCODE_MOVE_HOME, KC_KEY_HOME},
+    {AKEYCODE_MOVE_END, KC_KEY_END},
+    {AKEYCODE_INSERT, KC_KEY_INSERT},
+    {AKEYCODE_FORWARD, KC_KEY_UNKNOWN},
+    {AKEYCODE_MEDIA_PLAY, KC_KEY_PLAY},
+    {AKEYCODE_MEDIA_PAUSE, KC_KEY_MEDIA_PLAY_PAUSE},
+    {AKEYCODE_MEDIA_CLOSE, KC_KEY_UNKNOWN},
+    {AKEYCODE_MEDIA_EJECT, KC_KEY_UNKNOWN},
+    {AKEYCODE_MEDIA_RECORD, KC_KEY_UNKNOWN},
+    {AKEYCODE_F1, KC_KEY_F1},
+    {AKEYCODE_F2, KC_KEY_F2},
+    {AKEYCODE_F3, KC_KEY_F3},
+    {AKEYCODE_F4, KC_KEY_F4},
+    {AKEYCODE_F5, KC_KEY_F5},
+    {AKEYCODE_F6, KC_KEY_F6},
+    {AKEYCODE_F7, KC_KEY_F7},
+    {AKEYCODE_F8, KC_KEY_F8},
+    {AKEYCODE_F9, KC_KEY_F9},
+    {AKEYCODE_F10, KC_KEY_F10},
+    {AKEYCODE_F11, KC_KEY_F11},
+    {AKEYCODE_F12, KC_KEY_F12},
+    {AKEYCODE_NUM_LOCK, KC_KEY_NUMLOCK},
+    {AKEYCODE_NUMPAD_0, KC_KEY_NUMPAD0},
+    {AKEYCODE_NUMPAD_1, KC_KEY_NUMPAD1},
+    {AKEYCODE_NUMPAD_2, KC_KEY_NUMPAD2},
+    {AKEYCODE_NUMPAD_3, KC_KEY_NUMPAD3},
+    {AKEYCODE_NUMPAD_4, KC_KEY_NUMPAD4},
+    {AKEYCODE_NUMPAD_5, KC_KEY_NUMPAD5},
+    {AKEYCODE_NUMPAD_6, KC_KEY_NUMPAD6},
+    {AKEYCODE_NUMPAD_7, KC_KEY_NUMPAD7},
+    {AKEYCODE_NUMPAD_8, KC_KEY_NUMPAD8},
+    {AKEYCODE_NUMPAD_9, KC_KEY_NUMPAD9},
+    {AKEYCODE_NUMPAD_DIVIDE, KC_KEY_DIVIDE},
+    {AKEYCODE_NUMPAD_MULTIPLY, KC_KEY_MULTIPLY},
+    {AKEYCODE_NUMPAD_SUBTRACT, KC_KEY_SUBTRACT},
+    {AKEYCODE_NUMPAD_ADD, KC_KEY_ADD},
+    {AKEYCODE_NUMPAD_DOT, KC_KEY_UNKNOWN},
+    {AKEYCODE_NUMPAD_COMMA, KC_KEY_COMMA},
+    {AKEYCODE_NUMPAD_ENTER, KC_KEY_RETURN},
+    {AKEYCODE_NUMPAD_EQUALS, KC_KEY_UNKNOWN},
+    {AKEYCODE_NUMPAD_LEFT_PAREN, KC_KEY_UNKNOWN},
+    {AKEYCODE_NUMPAD_RIGHT_PAREN, KC_KEY_UNKNOWN},
+    {AKEYCODE_VOLUME_MUTE, KC_KEY_VOLUME_MUTE},
+    {AKEYCODE_INFO, KC_KEY_UNKNOWN},
+    {AKEYCODE_CHANNEL_UP, KC_KEY_UNKNOWN},
+    {AKEYCODE_CHANNEL_DOWN, KC_KEY_UNKNOWN},
+    {AKEYCODE_ZOOM_IN, KC_KEY_ZOOM},
+    {AKEYCODE_ZOOM_OUT, KC_KEY_UNKNOWN},
+    {AKEYCODE_TV, KC_KEY_UNKNOWN},
+    {AKEYCODE_WINDOW, KC_KEY_UNKNOWN},
+    {AKEYCODE_GUIDE, KC_KEY_UNKNOWN},
+    {AKEYCODE_DVR, KC_KEY_UNKNOWN},
+    {AKEYCODE_BOOKMARK, KC_KEY_UNKNOWN},
+    {AKEYCODE_CAPTIONS, KC_KEY_UNKNOWN},
+    {AKEYCODE_SETTINGS, KC_KEY_UNKNOWN},
+    {AKEYCODE_TV_POWER, KC_KEY_UNKNOWN},
+    {AKEYCODE_TV_INPUT, KC_KEY_UNKNOWN},
+    {AKEYCODE_STB_POWER, KC_KEY_UNKNOWN},
+    {AKEYCODE_STB_INPUT, KC_KEY_UNKNOWN},
+    {AKEYCODE_AVR_POWER, KC_KEY_UNKNOWN},
+    {AKEYCODE_AVR_INPUT, KC_KEY_UNKNOWN},
+    {AKEYCODE_PROG_RED, KC_KEY_UNKNOWN},
+    {AKEYCODE_PROG_GREEN, KC_KEY_UNKNOWN},
+    {AKEYCODE_PROG_YELLOW, KC_KEY_UNKNOWN},
+    {AKEYCODE_PROG_BLUE, KC_KEY_UNKNOWN},
+    {AKEYCODE_APP_SWITCH, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_1, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_2, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_3, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_4, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_5, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_6, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_7, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_8, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_9, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_10, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_11, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_12, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_13, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_14, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_15, KC_KEY_UNKNOWN},
+    {AKEYCODE_BUTTON_16, KC_KEY_UNKNOWN},
+    {AKEYCODE_LANGUAGE_SWITCH, KC_KEY_UNKNOWN},
+    {AKEYCODE_MANNER_MODE, KC_KEY_UNKNOWN},
+    {AKEYCODE_3D_MODE, KC_KEY_UNKNOWN}
+};
+
+static_assert(countKeysInRange(g_key_map, 0, 0xff) ==
+              sizeof(g_key_map) / sizeof(g_key_map[0]), 
+              "Key is out of the table range");
+
+static constexpr KeyTable<0x100> g_keys = makeKeyTable<0x100>(g_key_map, 0);
+
 int DeviceAndroid::onEvent(android_app* app, AInputEvent* input_event)
 {
     DeviceAndroid* device = (DeviceAndroid*)app->userData;
@@ -208,10 +437,14 @@ int DeviceAndroid::onEvent(android_app* app, AInputEvent* input_event)
     
     int status = 0;
     
+    // Events are queued by the system with their own time in the monotonic
+    // clock, so it's used instead of the time when the looper is polled
     switch (AInputEvent_getType(input_event))
     {
     case AINPUT_EVENT_TYPE_MOTION:
     {
+        device->m_event_time = AMotionEvent_getEventTime(input_event) / 1000;
+        
         Event event;
         event.type = ET_TOUCH_EVENT;
         event.touch.type = TE_COUNT;
@@ -307,6 +540,8 @@ int DeviceAndroid::onEvent(android_app* app, AInputEvent* input_event)
     }
     case AINPUT_EVENT_TYPE_KEY:
     {
+        device->m_event_time = AKeyEvent_getEventTime(input_event) / 1000;
+        
         bool ignore_event = false;
 
         int32_t key_code = AKeyEvent_getKeyCode(input_event);
@@ -317,7 +552,12 @@ int DeviceAndroid::onEvent(android_app* app, AInputEvent* input_event)
         Event event;
         event.type = ET_KEY_EVENT;
         event.key.text[0] = 0;
-        event.key.id = device->m_key_map[key_code];
+        event.key.id = KC_KEY_UNKNOWN;
+        
+        if (key_code >= 0 && key_code <= 0xff)
+        {
+            event.key.id = g_keys.ids[key_code];
+        }
         event.key.pressed = (key_action == AKEY_EVENT_ACTION_DOWN);
 
         event.key.shift = (key_meta_state & AMETA_SHIFT_ON ||
@@ -413,219 +653,6 @@ void DeviceAndroid::getKeyChar(Event& event, unsigned int system_key_code)
     }
 }
 
-void DeviceAndroid::createKeyMap()
-{
-    m_key_map[AKEYCODE_UNKNOWN] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_SOFT_LEFT] = KC_KEY_LBUTTON; 
-    m_key_map[AKEYCODE_SOFT_RIGHT] = KC_KEY_RBUTTON; 
-    m_key_map[AKEYCODE_HOME] = KC_KEY_HOME; 
-    m_key_map[AKEYCODE_BACK] = KC_KEY_ESCAPE; 
-    m_key_map[AKEYCODE_CALL] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_ENDCALL] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_0] = KC_KEY_0; 
-    m_key_map[AKEYCODE_1] = KC_KEY_1; 
-    m_key_map[AKEYCODE_2] = KC_KEY_2; 
-    m_key_map[AKEYCODE_3] = KC_KEY_3; 
-    m_key_map[AKEYCODE_4] = KC_KEY_4; 
-    m_key_map[AKEYCODE_5] = KC_KEY_5; 
-    m_key_map[AKEYCODE_6] = KC_KEY_6; 
-    m_key_map[AKEYCODE_7] = KC_KEY_7; 
-    m_key_map[AKEYCODE_8] = KC_KEY_8; 
-    m_key_map[AKEYCODE_9] = KC_KEY_9; 
-    m_key_map[AKEYCODE_STAR] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_POUND] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_DPAD_UP] = KC_KEY_UP; 
-    m_key_map[AKEYCODE_DPAD_DOWN] = KC_KEY_DOWN; 
-    m_key_map[AKEYCODE_DPAD_LEFT] = KC_KEY_LEFT; 
-    m_key_map[AKEYCODE_DPAD_RIGHT] = KC_KEY_RIGHT; 
-    m_key_map[AKEYCODE_DPAD_CENTER] = KC_KEY_SELECT; 
-    m_key_map[AKEYCODE_VOLUME_UP] = KC_KEY_VOLUME_DOWN; 
-    m_key_map[AKEYCODE_VOLUME_DOWN] = KC_KEY_VOLUME_UP; 
-    m_key_map[AKEYCODE_POWER] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_CAMERA] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_CLEAR] = KC_KEY_CLEAR; 
-    m_key_map[AKEYCODE_A] = KC_KEY_A; 
-    m_key_map[AKEYCODE_B] = KC_KEY_B; 
-    m_key_map[AKEYCODE_C] = KC_KEY_C; 
-    m_key_map[AKEYCODE_D] = KC_KEY_D; 
-    m_key_map[AKEYCODE_E] = KC_KEY_E; 
-    m_key_map[AKEYCODE_F] = KC_KEY_F; 
-    m_key_map[AKEYCODE_G] = KC_KEY_G; 
-    m_key_map[AKEYCODE_H] = KC_KEY_H; 
-    m_key_map[AKEYCODE_I] = KC_KEY_I; 
-    m_key_map[AKEYCODE_J] = KC_KEY_J; 
-    m_key_map[AKEYCODE_K] = KC_KEY_K; 
-    m_key_map[AKEYCODE_L] = KC_KEY_L; 
-    m_key_map[AKEYCODE_M] = KC_KEY_M; 
-    m_key_map[AKEYCODE_N] = KC_KEY_N; 
-    m_key_map[AKEYCODE_O] = KC_KEY_O; 
-    m_key_map[AKEYCODE_P] = KC_KEY_P; 
-    m_key_map[AKEYCODE_Q] = KC_KEY_Q; 
-    m_key_map[AKEYCODE_R] = KC_KEY_R; 
-    m_key_map[AKEYCODE_S] = KC_KEY_S; 
-    m_key_map[AKEYCODE_T] = KC_KEY_T; 
-    m_key_map[AKEYCODE_U] = KC_KEY_U; 
-    m_key_map[AKEYCODE_V] = KC_KEY_V; 
-    m_key_map[AKEYCODE_W] = KC_KEY_W; 
-    m_key_map[AKEYCODE_X] = KC_KEY_X; 
-    m_key_map[AKEYCODE_Y] = KC_KEY_Y; 
-    m_key_map[AKEYCODE_Z] = KC_KEY_Z; 
-    m_key_map[AKEYCODE_COMMA] = KC_KEY_COMMA; 
-    m_key_map[AKEYCODE_PERIOD] = KC_KEY_PERIOD; 
-    m_key_map[AKEYCODE_ALT_LEFT] = KC_KEY_MENU; 
-    m_key_map[AKEYCODE_ALT_RIGHT] = KC_KEY_MENU; 
-    m_key_map[AKEYCODE_SHIFT_LEFT] = KC_KEY_LSHIFT; 
-    m_key_map[AKEYCODE_SHIFT_RIGHT] = KC_KEY_RSHIFT; 
-    m_key_map[AKEYCODE_TAB] = KC_KEY_TAB; 
-    m_key_map[AKEYCODE_SPACE] = KC_KEY_SPACE; 
-    m_key_map[AKEYCODE_SYM] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_EXPLORER] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_ENVELOPE] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_ENTER] = KC_KEY_RETURN; 
-    m_key_map[AKEYCODE_DEL] = KC_KEY_BACK; 
-    m_key_map[AKEYCODE_GRAVE] = KC_KEY_OEM_3; 
-    m_key_map[AKEYCODE_MINUS] = KC_KEY_MINUS; 
-    m_key_map[AKEYCODE_EQUALS] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_LEFT_BRACKET] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_RIGHT_BRACKET] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BACKSLASH] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_SEMICOLON] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_APOSTROPHE] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_SLASH] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_AT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_NUM] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_HEADSETHOOK] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_FOCUS] = KC_KEY_UNKNOWN;
-    m_key_map[AKEYCODE_PLUS] = KC_KEY_PLUS; 
-    m_key_map[AKEYCODE_MENU] = KC_KEY_MENU; 
-    m_key_map[AKEYCODE_NOTIFICATION] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_SEARCH] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_MEDIA_PLAY_PAUSE] = KC_KEY_MEDIA_PLAY_PAUSE; 
-    m_key_map[AKEYCODE_MEDIA_STOP] = KC_KEY_MEDIA_STOP; 
-    m_key_map[AKEYCODE_MEDIA_NEXT] = KC_KEY_MEDIA_NEXT_TRACK; 
-    m_key_map[AKEYCODE_MEDIA_PREVIOUS] = KC_KEY_MEDIA_PREV_TRACK; 
-    m_key_map[AKEYCODE_MEDIA_REWIND] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_MEDIA_FAST_FORWARD] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_MUTE] = KC_KEY_VOLUME_MUTE; 
-    m_key_map[AKEYCODE_PAGE_UP] = KC_KEY_PRIOR; 
-    m_key_map[AKEYCODE_PAGE_DOWN] = KC_KEY_NEXT; 
-    m_key_map[AKEYCODE_PICTSYMBOLS] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_SWITCH_CHARSET] = KC_KEY_UNKNOWN; 
-
-    m_key_map[AKEYCODE_BUTTON_A] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_B] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_C] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_X] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_Y] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_Z] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_L1] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_R1] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_L2] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_R2] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_THUMBL] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_THUMBR] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_START] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_SELECT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_MODE] = KC_KEY_UNKNOWN; 
-
-    m_key_map[AKEYCODE_ESCAPE] = KC_KEY_ESCAPE; 
-    m_key_map[AKEYCODE_FORWARD_DEL] = KC_KEY_DELETE; 
-    m_key_map[AKEYCODE_CTRL_LEFT] = KC_KEY_CONTROL; 
-    m_key_map[AKEYCODE_CTRL_RIGHT] = KC_KEY_CONTROL; 
-    m_key_map[AKEYCODE_CAPS_LOCK] = KC_KEY_CAPITAL; 
-    m_key_map[AKEYCODE_SCROLL_LOCK] = KC_KEY_SCROLL; 
-    m_key_map[AKEYCODE_META_LEFT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_META_RIGHT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_FUNCTION] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_SYSRQ] = KC_KEY_SNAPSHOT; 
-    m_key_map[AKEYCODE_BREAK] = KC_KEY_PAUSE; 
-    m_key_map[AKEYCODE_MOVE_HOME] = KC_KEY_HOME; 
-    m_key_map[AKEYCODE_MOVE_END] = KC_KEY_END; 
-    m_key_map[AKEYCODE_INSERT] = KC_KEY_INSERT; 
-    m_key_map[AKEYCODE_FORWARD] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_MEDIA_PLAY] = KC_KEY_PLAY; 
-    m_key_map[AKEYCODE_MEDIA_PAUSE] = KC_KEY_MEDIA_PLAY_PAUSE; 
-    m_key_map[AKEYCODE_MEDIA_CLOSE] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_MEDIA_EJECT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_MEDIA_RECORD] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_F1] = KC_KEY_F1; 
-    m_key_map[AKEYCODE_F2] = KC_KEY_F2; 
-    m_key_map[AKEYCODE_F3] = KC_KEY_F3; 
-    m_key_map[AKEYCODE_F4] = KC_KEY_F4; 
-    m_key_map[AKEYCODE_F5] = KC_KEY_F5; 
-    m_key_map[AKEYCODE_F6] = KC_KEY_F6; 
-    m_key_map[AKEYCODE_F7] = KC_KEY_F7; 
-    m_key_map[AKEYCODE_F8] = KC_KEY_F8; 
-    m_key_map[AKEYCODE_F9] = KC_KEY_F9; 
-    m_key_map[AKEYCODE_F10] = KC_KEY_F10; 
-    m_key_map[AKEYCODE_F11] = KC_KEY_F11; 
-    m_key_map[AKEYCODE_F12] = KC_KEY_F12; 
-    m_key_map[AKEYCODE_NUM_LOCK] = KC_KEY_NUMLOCK; 
-    m_key_map[AKEYCODE_NUMPAD_0] = KC_KEY_NUMPAD0; 
-    m_key_map[AKEYCODE_NUMPAD_1] = KC_KEY_NUMPAD1; 
-    m_key_map[AKEYCODE_NUMPAD_2] = KC_KEY_NUMPAD2; 
-    m_key_map[AKEYCODE_NUMPAD_3] = KC_KEY_NUMPAD3; 
-    m_key_map[AKEYCODE_NUMPAD_4] = KC_KEY_NUMPAD4; 
-    m_key_map[AKEYCODE_NUMPAD_5] = KC_KEY_NUMPAD5; 
-    m_key_map[AKEYCODE_NUMPAD_6] = KC_KEY_NUMPAD6; 
-    m_key_map[AKEYCODE_NUMPAD_7] = KC_KEY_NUMPAD7; 
-    m_key_map[AKEYCODE_NUMPAD_8] = KC_KEY_NUMPAD8; 
-    m_key_map[AKEYCODE_NUMPAD_9] = KC_KEY_NUMPAD9; 
-    m_key_map[AKEYCODE_NUMPAD_DIVIDE] = KC_KEY_DIVIDE; 
-    m_key_map[AKEYCODE_NUMPAD_MULTIPLY] = KC_KEY_MULTIPLY; 
-    m_key_map[AKEYCODE_NUMPAD_SUBTRACT] = KC_KEY_SUBTRACT; 
-    m_key_map[AKEYCODE_NUMPAD_ADD] = KC_KEY_ADD; 
-    m_key_map[AKEYCODE_NUMPAD_DOT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_NUMPAD_COMMA] = KC_KEY_COMMA; 
-    m_key_map[AKEYCODE_NUMPAD_ENTER] = KC_KEY_RETURN; 
-    m_key_map[AKEYCODE_NUMPAD_EQUALS] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_NUMPAD_LEFT_PAREN] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_NUMPAD_RIGHT_PAREN] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_VOLUME_MUTE] = KC_KEY_VOLUME_MUTE; 
-    m_key_map[AKEYCODE_INFO] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_CHANNEL_UP] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_CHANNEL_DOWN] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_ZOOM_IN] = KC_KEY_ZOOM; 
-    m_key_map[AKEYCODE_ZOOM_OUT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_TV] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_WINDOW] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_GUIDE] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_DVR] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BOOKMARK] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_CAPTIONS] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_SETTINGS] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_TV_POWER] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_TV_INPUT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_STB_POWER] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_STB_INPUT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_AVR_POWER] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_AVR_INPUT] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_PROG_RED] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_PROG_GREEN] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_PROG_YELLOW] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_PROG_BLUE] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_APP_SWITCH] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_1] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_2] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_3] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_4] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_5] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_6] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_7] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_8] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_9] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_10] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_11] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_12] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_13] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_14] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_15] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_BUTTON_16] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_LANGUAGE_SWITCH] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_MANNER_MODE] = KC_KEY_UNKNOWN; 
-    m_key_map[AKEYCODE_3D_MODE] = KC_KEY_UNKNOWN; 
-}
-
 void DeviceAndroid::initSensors()
 {
     m_sensor_manager = ASensorManager_getInstance();
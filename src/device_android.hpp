@@ -25,7 +25,6 @@
 #include <android/sensor.h>
 #include <android_native_app_glue.h>
 
-#include <map>
 #include <string>
 
 struct SensorInfo
@@ -53,11 +52,8 @@ private:
     bool m_is_mouse_pressed;
     int m_cursor_x;
     int m_cursor_y;
-
-    std::map<int, KeyId> m_key_map;
     
     void createVideoModeList();
-    void createKeyMap();
     void getKeyChar(Event& event, unsigned int system_key_code);
     void initSensors();
     void closeSensors();
@@ -72,7 +68,7 @@ public:
 
     bool initDevice(const CreationParams& creation_params);
     void closeDevice();
-    bool processEvents();
+    bool processEvents(int timeout_ms);
     void clearSystemMessages() {};
     
     void setWindowCaption(const char* text) {};
@@ -89,6 +85,7 @@ public:
     void setWindowMaximized() {};
     
     std::string getClipboardContent() {return "";}
+    void requestClipboardContent(ClipboardCallback callback) {callback("");}
     void setClipboardContent(std::string text) {};
 
     void setCursorVisible(bool visible) {};
@@ -0,0 +1,140 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_headless.hpp"
+#include "render_target.hpp"
+
+#include <cstdio>
+
+DeviceHeadless::DeviceHeadless()
+{
+    m_render_target = NULL;
+    m_frames_limit = 0;
+    m_frames_count = 0;
+    m_close = false;
+    m_cursor_is_visible = true;
+    m_cursor_x = -1;
+    m_cursor_y = -1;
+}
+
+DeviceHeadless::~DeviceHeadless()
+{
+    delete m_render_target;
+    delete m_egl_context;
+}
+
+bool DeviceHeadless::createHeadlessContext(ContextEGLPlatform platform, 
+                                           ContextEGLSurfaceType surface_type)
+{
+    ContextEGLParams egl_params;
+
+    if (m_creation_params.driver_type == DriverType::DRIVER_OPENGL_ES)
+    {
+        egl_params.opengl_api = CEGL_API_OPENGL_ES;
+    }
+    else
+    {
+        egl_params.opengl_api = CEGL_API_OPENGL;
+    }
+
+    egl_params.platform = platform;
+    egl_params.surface_type = surface_type;
+    egl_params.force_legacy_device = m_creation_params.force_legacy_device;
+    egl_params.handle_srgb = m_creation_params.handle_srgb;
+    egl_params.with_alpha_channel = m_creation_params.alpha_channel;
+    egl_params.vsync_enabled = false;
+    egl_params.window = 0;
+    egl_params.display = EGL_DEFAULT_DISPLAY;
+    egl_params.pbuffer_width = m_window_width;
+    egl_params.pbuffer_height = m_window_height;
+
+    m_egl_context = new ContextManagerEGL();
+    bool success = m_egl_context->init(egl_params);
+    
+    if (!success)
+    {
+        delete m_egl_context;
+        m_egl_context = NULL;
+    }
+
+    return success;
+}
+
+bool DeviceHeadless::initDevice(const CreationParams& creation_params)
+{
+    m_creation_params = creation_params;
+    m_window_width = m_creation_params.window_width;
+    m_window_height = m_creation_params.window_height;
+    
+    m_video_desktop = VideoMode(m_window_width, m_window_height, 32);
+    m_video_modes.push_back(m_video_desktop);
+    
+    bool success = createHeadlessContext(CEGL_PLATFORM_SURFACELESS, 
+                                         CEGL_SURFACE_NONE);
+    
+    if (!success)
+    {
+        printf("Warning: Surfaceless context is not available, trying "
+               "pbuffer.\n");
+        success = createHeadlessContext(CEGL_PLATFORM_DEFAULT, 
+                                        CEGL_SURFACE_PBUFFER);
+    }
+    
+    if (!success)
+    {
+        printf("Error: Couldn't create headless EGL context.\n");
+        return false;
+    }
+    
+    // It's left bound, so that it's used as a default framebuffer
+    m_render_target = new RenderTarget();
+    success = m_render_target->init(m_window_width, m_window_height, true);
+    
+    if (!success)
+    {
+        printf("Error: Couldn't create render target.\n");
+        return false;
+    }
+    
+    return true;
+}
+
+bool DeviceHeadless::processEvents(int timeout_ms)
+{
+    return !m_close;
+}
+
+void DeviceHeadless::swapBuffers()
+{
+    if (!m_dump_path.empty())
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "/frame_%05u.png", m_frames_count);
+        m_render_target->saveToPNG(m_dump_path + name);
+    }
+    
+    Device::swapBuffers();
+    
+    m_frames_count++;
+    
+    if (m_frames_limit > 0 && m_frames_count >= m_frames_limit)
+    {
+        m_close = true;
+    }
+    
+    // There is nothing that could request a redraw, so all frames are drawn
+    requestRedraw();
+}
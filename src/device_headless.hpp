@@ -0,0 +1,86 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DEVICE_HEADLESS_HPP
+#define DEVICE_HEADLESS_HPP
+
+#include "device.hpp"
+
+#include <string>
+
+class RenderTarget;
+
+// Device without a window. It renders into a framebuffer object using
+// surfaceless EGL context, or a pbuffer when surfaceless context is not
+// available. Every frame is drawn and can be saved to a PNG file.
+class DeviceHeadless : public Device
+{
+private:
+    RenderTarget* m_render_target;
+    std::string m_clipboard;
+    std::string m_dump_path;
+    unsigned int m_frames_limit;
+    unsigned int m_frames_count;
+    bool m_close;
+    bool m_cursor_is_visible;
+    int m_cursor_x;
+    int m_cursor_y;
+    
+    bool createHeadlessContext(ContextEGLPlatform platform, 
+                               ContextEGLSurfaceType surface_type);
+    
+public:
+    DeviceHeadless();
+    ~DeviceHeadless();
+    
+    bool initDevice(const CreationParams& creation_params);
+    void closeDevice() {m_close = true;}
+    bool processEvents(int timeout_ms);
+    void clearSystemMessages() {}
+    void swapBuffers();
+    
+    void setWindowCaption(const char* text) {}
+    void setWindowClass(const char* text) {}
+    void setWindowFullscreen(bool fullscreen) {}
+    void setWindowResizable(bool resizable) {}
+    bool isWindowActive() {return true;}
+    bool isWindowFocused() {return true;}
+    bool isWindowMinimized() {return false;}
+    bool isWindowFullscreen() {return false;}
+    bool setWindowPosition(int x, int y) {return false;}
+    bool getWindowPosition(int* x, int* y) {return false;}
+    void setWindowMinimized() {}
+    void setWindowMaximized() {}
+    
+    std::string getClipboardContent() {return m_clipboard;}
+    void requestClipboardContent(ClipboardCallback callback) 
+                                                    {callback(m_clipboard);}
+    void setClipboardContent(std::string text) {m_clipboard = text;}
+
+    void setCursorVisible(bool visible) {m_cursor_is_visible = visible;}
+    bool isCursorVisible() {return m_cursor_is_visible;}
+    void setCursorPosition(int x, int y) {m_cursor_x = x; m_cursor_y = y;}
+    void getCursorPosition(int* x, int* y) {*x = m_cursor_x; *y = m_cursor_y;}
+    
+    // Device is closed after frames_limit frames, 0 means no limit
+    void setFramesLimit(unsigned int frames_limit) 
+                                            {m_frames_limit = frames_limit;}
+    // Frames are saved as frame_NNNNN.png in this directory when it's set
+    void setDumpPath(std::string dump_path) {m_dump_path = dump_path;}
+    RenderTarget* getRenderTarget() {return m_render_target;}
+};
+
+#endif
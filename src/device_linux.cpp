@@ -17,6 +17,7 @@
 #if (defined(__linux__) || defined(__CYGWIN__)) && !defined(ANDROID)
 
 #include "device_linux.hpp"
+#include "key_map.hpp"
 
 #include <algorithm>
 #include <climits>
@@ -25,19 +26,30 @@
 #include <cstring>
 #include <ctime>
 #include <locale.h>
+#include <poll.h>
 #include <X11/XKBlib.h>
 #include <X11/Xatom.h>
 
 #ifndef __CYGWIN__
+#include <cerrno>
 #include <fcntl.h>
 #include <unistd.h>
 #include <linux/input.h>
 #include <linux/joystick.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #endif
 
 #define XRANDR_ROTATION_LEFT    (1 << 1)
 #define XRANDR_ROTATION_RIGHT   (1 << 3)
 
+// Time in microseconds to wait for the clipboard owner, or for the next
+// chunk of INCR transfer
+#define CLIPBOARD_TIMEOUT 500000
+
+#define INPUT_MAX_EVENTS 16
+
 DeviceLinux::DeviceLinux()
 {
     m_display = NULL;
@@ -57,6 +69,10 @@ DeviceLinux::DeviceLinux()
     m_atom_clipboard = None;
     m_atom_targets = None;
     m_atom_utf8_string = None;
+    m_atom_clipboard_property = None;
+    m_atom_incr = None;
+    m_clipboard_incr = false;
+    m_clipboard_deadline = 0;
 
     m_output_id = 0;
     m_default_mode = 0;
@@ -68,6 +84,13 @@ DeviceLinux::DeviceLinux()
     m_input_context = 0;
     m_numlock_mask = 0;
 
+    m_epoll_fd = -1;
+    m_inotify_fd = -1;
+    m_input_thread_stop = false;
+    m_input_thread_active = false;
+    m_input_event_fd = -1;
+    m_atom_input_wakeup = None;
+    m_input_clear_time = 0;
     m_cursor_invisible = 0;
     m_cursor_is_visible = true;
     m_cursor_x = 0;
@@ -80,6 +103,14 @@ bool DeviceLinux::initDevice(const CreationParams& creation_params)
     m_window_width = creation_params.window_width;
     m_window_height = creation_params.window_height;
     
+    // Must be the first Xlib call, so that the input thread can share the
+    // connection
+    if (m_creation_params.input_thread && XInitThreads() == 0)
+    {
+        printf("Warning: Couldn't initialize Xlib for threads.\n");
+        m_creation_params.input_thread = false;
+    }
+    
     XSetErrorHandler(printXError);
 
     m_display = XOpenDisplay(0);
@@ -103,7 +134,6 @@ bool DeviceLinux::initDevice(const CreationParams& creation_params)
     }
 
     initCursor();
-    createKeyMap();
     findNumlockMask();
     
     success = createInputContext();
@@ -113,6 +143,18 @@ bool DeviceLinux::initDevice(const CreationParams& creation_params)
         printf("Warning: Couldn't create input context.\n");
     }
     
+    if (m_creation_params.input_thread)
+    {
+        success = startInputThread();
+        
+        if (!success)
+        {
+            printf("Warning: Couldn't start input thread.\n");
+        }
+    }
+    
+    initInputReactor();
+    
     if (creation_params.joystick_support)
     {
         activateJoysticks();
@@ -127,6 +169,7 @@ DeviceLinux::~DeviceLinux()
     
     if (m_display)
     {
+        stopInputThread();
         destroyInputContext();
         closeCursor();
         XDestroyWindow(m_display, m_window);
@@ -146,6 +189,7 @@ DeviceLinux::~DeviceLinux()
     }
     
     closeJoysticks();
+    closeInputReactor();
 }
 
 int DeviceLinux::printXError(Display* display, XErrorEvent* event)
@@ -495,7 +539,8 @@ bool DeviceLinux::createWindow()
     attributes.override_redirect = false;
     attributes.event_mask = StructureNotifyMask | FocusChangeMask | 
                             ExposureMask | PointerMotionMask | ButtonPressMask | 
-                            KeyPressMask | ButtonReleaseMask | KeyReleaseMask;
+                            KeyPressMask | ButtonReleaseMask | KeyReleaseMask |
+                            PropertyChangeMask;
 
     m_window = XCreateWindow(m_display, root_window, 0, 0, m_window_width, 
                              m_window_height, 0, m_visual->depth, InputOutput, 
@@ -540,6 +585,9 @@ bool DeviceLinux::createWindow()
     m_atom_clipboard = XInternAtom(m_display, "CLIPBOARD", false);
     m_atom_targets = XInternAtom(m_display, "TARGETS", false);
     m_atom_utf8_string = XInternAtom (m_display, "UTF8_STRING", false);
+    m_atom_clipboard_property = XInternAtom(m_display, "CLIPBOARD_SELECTION", 
+                                            false);
+    m_atom_incr = XInternAtom(m_display, "INCR", false);
 
     m_std_hints = XAllocSizeHints();
     long num_hints;
@@ -655,6 +703,216 @@ void DeviceLinux::findNumlockMask()
     XFreeModifiermap(map);
 }
 
+// Latin-1 keysyms and function keysyms from 0xff00 are dense enough to be
+// expanded into lookup tables at compile time
+static constexpr KeyMapEntry g_key_map[] =
+{
+    {XK_BackSpace, KC_KEY_BACK},
+    {XK_Tab, KC_KEY_TAB},
+    {XK_Linefeed, KC_KEY_UNKNOWN},
+    {XK_Clear, KC_KEY_CLEAR},
+    {XK_Return, KC_KEY_RETURN},
+    {XK_Pause, KC_KEY_PAUSE},
+    {XK_Scroll_Lock, KC_KEY_SCROLL},
+    {XK_Sys_Req, KC_KEY_UNKNOWN},
+    {XK_Escape, KC_KEY_ESCAPE},
+    {XK_Insert, KC_KEY_INSERT},
+    {XK_Delete, KC_KEY_DELETE},
+    {XK_Home, KC_KEY_HOME},
+    {XK_Left, KC_KEY_LEFT},
+    {XK_Up, KC_KEY_UP},
+    {XK_Right, KC_KEY_RIGHT},
+    {XK_Down, KC_KEY_DOWN},
+    {XK_Prior, KC_KEY_PRIOR},
+    {XK_Page_Up, KC_KEY_PRIOR},
+    {XK_Next, KC_KEY_NEXT},
+    {XK_Page_Down, KC_KEY_NEXT},
+    {XK_End, KC_KEY_END},
+    {XK_Begin, KC_KEY_HOME},
+    {XK_Num_Lock, KC_KEY_NUMLOCK},
+    {XK_KP_Space, KC_KEY_SPACE},
+    {XK_KP_Tab, KC_KEY_TAB},
+    {XK_KP_Enter, KC_KEY_RETURN},
+    {XK_KP_F1, KC_KEY_F1},
+    {XK_KP_F2, KC_KEY_F2},
+    {XK_KP_F3, KC_KEY_F3},
+    {XK_KP_F4, KC_KEY_F4},
+    {XK_KP_Home, KC_KEY_HOME},
+    {XK_KP_Left, KC_KEY_LEFT},
+    {XK_KP_Up, KC_KEY_UP},
+    {XK_KP_Right, KC_KEY_RIGHT},
+    {XK_KP_Down, KC_KEY_DOWN},
+    {XK_Print, KC_KEY_PRINT},
+    {XK_KP_Prior, KC_KEY_PRIOR},
+    {XK_KP_Page_Up, KC_KEY_PRIOR},
+    {XK_KP_Next, KC_KEY_NEXT},
+    {XK_KP_Page_Down, KC_KEY_NEXT},
+    {XK_KP_End, KC_KEY_END},
+    {XK_KP_Begin, KC_KEY_HOME},
+    {XK_KP_Insert, KC_KEY_INSERT},
+    {XK_KP_Delete, KC_KEY_DELETE},
+    {XK_KP_Equal, KC_KEY_UNKNOWN},
+    {XK_KP_Multiply, KC_KEY_MULTIPLY},
+    {XK_KP_Add, KC_KEY_ADD},
+    {XK_KP_Separator, KC_KEY_SEPARATOR},
+    {XK_KP_Subtract, KC_KEY_SUBTRACT},
+    {XK_KP_Decimal, KC_KEY_DECIMAL},
+    {XK_KP_Divide, KC_KEY_DIVIDE},
+    {XK_KP_0, KC_KEY_NUMPAD0},
+    {XK_KP_1, KC_KEY_NUMPAD1},
+    {XK_KP_2, KC_KEY_NUMPAD2},
+    {XK_KP_3, KC_KEY_NUMPAD3},
+    {XK_KP_4, KC_KEY_NUMPAD4},
+    {XK_KP_5, KC_KEY_NUMPAD5},
+    {XK_KP_6, KC_KEY_NUMPAD6},
+    {XK_KP_7, KC_KEY_NUMPAD7},
+    {XK_KP_8, KC_KEY_NUMPAD8},
+    {XK_KP_9, KC_KEY_NUMPAD9},
+    {XK_F1, KC_KEY_F1},
+    {XK_F2, KC_KEY_F2},
+    {XK_F3, KC_KEY_F3},
+    {XK_F4, KC_KEY_F4},
+    {XK_F5, KC_KEY_F5},
+    {XK_F6, KC_KEY_F6},
+    {XK_F7, KC_KEY_F7},
+    {XK_F8, KC_KEY_F8},
+    {XK_F9, KC_KEY_F9},
+    {XK_F10, KC_KEY_F10},
+    {XK_F11, KC_KEY_F11},
+    {XK_F12, KC_KEY_F12},
+    {XK_Shift_L, KC_KEY_LSHIFT},
+    {XK_Shift_R, KC_KEY_RSHIFT},
+    {XK_Control_L, KC_KEY_LCONTROL},
+    {XK_Control_R, KC_KEY_RCONTROL},
+    {XK_Caps_Lock, KC_KEY_CAPITAL},
+    {XK_Shift_Lock, KC_KEY_CAPITAL},
+    {XK_Meta_L, KC_KEY_LWIN},
+    {XK_Meta_R, KC_KEY_RWIN},
+    {XK_Alt_L, KC_KEY_LMENU},
+    {XK_Alt_R, KC_KEY_RMENU},
+    {XK_Menu, KC_KEY_MENU},
+    {XK_space, KC_KEY_SPACE},
+    {XK_exclam, KC_KEY_UNKNOWN},
+    {XK_quotedbl, KC_KEY_UNKNOWN},
+    {XK_section, KC_KEY_UNKNOWN},
+    {XK_numbersign, KC_KEY_OEM_2},
+    {XK_dollar, KC_KEY_UNKNOWN},
+    {XK_percent, KC_KEY_UNKNOWN},
+    {XK_ampersand, KC_KEY_UNKNOWN},
+    {XK_apostrophe, KC_KEY_OEM_7},
+    {XK_parenleft, KC_KEY_UNKNOWN},
+    {XK_parenright, KC_KEY_UNKNOWN},
+    {XK_asterisk, KC_KEY_UNKNOWN},
+    {XK_plus, KC_KEY_PLUS},
+    {XK_comma, KC_KEY_COMMA},
+    {XK_minus, KC_KEY_MINUS},
+    {XK_period, KC_KEY_PERIOD},
+    {XK_slash, KC_KEY_OEM_2},
+    {XK_0, KC_KEY_0},
+    {XK_1, KC_KEY_1},
+    {XK_2, KC_KEY_2},
+    {XK_3, KC_KEY_3},
+    {XK_4, KC_KEY_4},
+    {XK_5, KC_KEY_5},
+    {XK_6, KC_KEY_6},
+    {XK_7, KC_KEY_7},
+    {XK_8, KC_KEY_8},
+    {XK_9, KC_KEY_9},
+    {XK_colon, KC_KEY_UNKNOWN},
+    {XK_semicolon, KC_KEY_OEM_1},
+    {XK_less, KC_KEY_OEM_102},
+    {XK_equal, KC_KEY_PLUS},
+    {XK_greater, KC_KEY_UNKNOWN},
+    {XK_question, KC_KEY_UNKNOWN},
+    {XK_at, KC_KEY_2},
+    {XK_mu, KC_KEY_UNKNOWN},
+    {XK_A, KC_KEY_A},
+    {XK_B, KC_KEY_B},
+    {XK_C, KC_KEY_C},
+    {XK_D, KC_KEY_D},
+    {XK_E, KC_KEY_E},
+    {XK_F, KC_KEY_F},
+    {XK_G, KC_KEY_G},
+    {XK_H, KC_KEY_H},
+    {XK_I, KC_KEY_I},
+    {XK_J, KC_KEY_J},
+    {XK_K, KC_KEY_K},
+    {XK_L, KC_KEY_L},
+    {XK_M, KC_KEY_M},
+    {XK_N, KC_KEY_N},
+    {XK_O, KC_KEY_O},
+    {XK_P, KC_KEY_P},
+    {XK_Q, KC_KEY_Q},
+    {XK_R, KC_KEY_R},
+    {XK_S, KC_KEY_S},
+    {XK_T, KC_KEY_T},
+    {XK_U, KC_KEY_U},
+    {XK_V, KC_KEY_V},
+    {XK_W, KC_KEY_W},
+    {XK_X, KC_KEY_X},
+    {XK_Y, KC_KEY_Y},
+    {XK_Z, KC_KEY_Z},
+    {XK_bracketleft, KC_KEY_OEM_4},
+    {XK_backslash, KC_KEY_OEM_5},
+    {XK_bracketright, KC_KEY_OEM_6},
+    {XK_asciicircum, KC_KEY_OEM_5},
+    {XK_degree, KC_KEY_UNKNOWN},
+    {XK_underscore, KC_KEY_MINUS},
+    {XK_grave, KC_KEY_OEM_3},
+    {XK_acute, KC_KEY_OEM_6},
+    {XK_a, KC_KEY_A},
+    {XK_b, KC_KEY_B},
+    {XK_c, KC_KEY_C},
+    {XK_d, KC_KEY_D},
+    {XK_e, KC_KEY_E},
+    {XK_f, KC_KEY_F},
+    {XK_g, KC_KEY_G},
+    {XK_h, KC_KEY_H},
+    {XK_i, KC_KEY_I},
+    {XK_j, KC_KEY_J},
+    {XK_k, KC_KEY_K},
+    {XK_l, KC_KEY_L},
+    {XK_m, KC_KEY_M},
+    {XK_n, KC_KEY_N},
+    {XK_o, KC_KEY_O},
+    {XK_p, KC_KEY_P},
+    {XK_q, KC_KEY_Q},
+    {XK_r, KC_KEY_R},
+    {XK_s, KC_KEY_S},
+    {XK_t, KC_KEY_T},
+    {XK_u, KC_KEY_U},
+    {XK_v, KC_KEY_V},
+    {XK_w, KC_KEY_W},
+    {XK_x, KC_KEY_X},
+    {XK_y, KC_KEY_Y},
+    {XK_z, KC_KEY_Z},
+    {XK_ssharp, KC_KEY_OEM_4},
+    {XK_adiaeresis, KC_KEY_OEM_7},
+    {XK_odiaeresis, KC_KEY_OEM_3},
+    {XK_udiaeresis, KC_KEY_OEM_1},
+    {XK_Super_L, KC_KEY_LWIN},
+    {XK_Super_R, KC_KEY_RWIN}
+};
+
+// Sorted by keysym
+static constexpr KeyMapEntry g_sparse_key_map[] =
+{
+    {XK_EuroSign, KC_KEY_UNKNOWN},
+    {XK_ISO_Level3_Shift, KC_KEY_RMENU},
+    {XK_ISO_Left_Tab, KC_KEY_TAB}
+};
+
+static_assert(countKeysInRange(g_key_map, 0x0000, 0x00ff) +
+              countKeysInRange(g_key_map, 0xff00, 0xffff) ==
+              sizeof(g_key_map) / sizeof(g_key_map[0]), 
+              "Key is out of the dense tables range");
+static_assert(areKeysSorted(g_sparse_key_map), "Sparse keys are not sorted");
+
+static constexpr KeyTable<0x100> g_latin1_keys = 
+                                        makeKeyTable<0x100>(g_key_map, 0x0000);
+static constexpr KeyTable<0x100> g_function_keys = 
+                                        makeKeyTable<0x100>(g_key_map, 0xff00);
+
 KeyId DeviceLinux::getKeyCode(XEvent &event)
 {
     KeyId key_code = KC_KEY_UNKNOWN;
@@ -679,7 +937,18 @@ KeyId DeviceLinux::getKeyCode(XEvent &event)
         keysym = XkbKeycodeToKeysym(m_display, event.xkey.keycode, 0, 0);
     }
     
-    key_code = m_key_map[keysym];
+    if (keysym >= 0 && keysym <= 0xff)
+    {
+        key_code = g_latin1_keys.ids[keysym];
+    }
+    else if (keysym >= 0xff00 && keysym <= 0xffff)
+    {
+        key_code = g_function_keys.ids[keysym - 0xff00];
+    }
+    else
+    {
+        key_code = findSparseKeyId(g_sparse_key_map, keysym);
+    }
     
     if (key_code == KC_KEY_UNKNOWN)
     {
@@ -689,219 +958,88 @@ KeyId DeviceLinux::getKeyCode(XEvent &event)
     return key_code;
 }
 
-void DeviceLinux::createKeyMap()
-{
-    m_key_map[XK_BackSpace] = KC_KEY_BACK;
-    m_key_map[XK_Tab] = KC_KEY_TAB;
-    m_key_map[XK_ISO_Left_Tab] = KC_KEY_TAB;
-    m_key_map[XK_Linefeed] = KC_KEY_UNKNOWN;
-    m_key_map[XK_Clear] = KC_KEY_CLEAR;
-    m_key_map[XK_Return] = KC_KEY_RETURN;
-    m_key_map[XK_Pause] = KC_KEY_PAUSE;
-    m_key_map[XK_Scroll_Lock] = KC_KEY_SCROLL;
-    m_key_map[XK_Sys_Req] = KC_KEY_UNKNOWN;
-    m_key_map[XK_Escape] = KC_KEY_ESCAPE;
-    m_key_map[XK_Insert] = KC_KEY_INSERT;
-    m_key_map[XK_Delete] = KC_KEY_DELETE;
-    m_key_map[XK_Home] = KC_KEY_HOME;
-    m_key_map[XK_Left] = KC_KEY_LEFT;
-    m_key_map[XK_Up] = KC_KEY_UP;
-    m_key_map[XK_Right] = KC_KEY_RIGHT;
-    m_key_map[XK_Down] = KC_KEY_DOWN;
-    m_key_map[XK_Prior] = KC_KEY_PRIOR;
-    m_key_map[XK_Page_Up] = KC_KEY_PRIOR;
-    m_key_map[XK_Next] = KC_KEY_NEXT;
-    m_key_map[XK_Page_Down] = KC_KEY_NEXT;
-    m_key_map[XK_End] = KC_KEY_END;
-    m_key_map[XK_Begin] = KC_KEY_HOME;
-    m_key_map[XK_Num_Lock] = KC_KEY_NUMLOCK;
-    m_key_map[XK_KP_Space] = KC_KEY_SPACE;
-    m_key_map[XK_KP_Tab] = KC_KEY_TAB;
-    m_key_map[XK_KP_Enter] = KC_KEY_RETURN;
-    m_key_map[XK_KP_F1] = KC_KEY_F1;
-    m_key_map[XK_KP_F2] = KC_KEY_F2;
-    m_key_map[XK_KP_F3] = KC_KEY_F3;
-    m_key_map[XK_KP_F4] = KC_KEY_F4;
-    m_key_map[XK_KP_Home] = KC_KEY_HOME;
-    m_key_map[XK_KP_Left] = KC_KEY_LEFT;
-    m_key_map[XK_KP_Up] = KC_KEY_UP;
-    m_key_map[XK_KP_Right] = KC_KEY_RIGHT;
-    m_key_map[XK_KP_Down] = KC_KEY_DOWN;
-    m_key_map[XK_Print] = KC_KEY_PRINT;
-    m_key_map[XK_KP_Prior] = KC_KEY_PRIOR;
-    m_key_map[XK_KP_Page_Up] = KC_KEY_PRIOR;
-    m_key_map[XK_KP_Next] = KC_KEY_NEXT;
-    m_key_map[XK_KP_Page_Down] = KC_KEY_NEXT;
-    m_key_map[XK_KP_End] = KC_KEY_END;
-    m_key_map[XK_KP_Begin] = KC_KEY_HOME;
-    m_key_map[XK_KP_Insert] = KC_KEY_INSERT;
-    m_key_map[XK_KP_Delete] = KC_KEY_DELETE;
-    m_key_map[XK_KP_Equal] = KC_KEY_UNKNOWN;
-    m_key_map[XK_KP_Multiply] = KC_KEY_MULTIPLY;
-    m_key_map[XK_KP_Add] = KC_KEY_ADD;
-    m_key_map[XK_KP_Separator] = KC_KEY_SEPARATOR;
-    m_key_map[XK_KP_Subtract] = KC_KEY_SUBTRACT;
-    m_key_map[XK_KP_Decimal] = KC_KEY_DECIMAL;
-    m_key_map[XK_KP_Divide] = KC_KEY_DIVIDE;
-    m_key_map[XK_KP_0] = KC_KEY_NUMPAD0;
-    m_key_map[XK_KP_1] = KC_KEY_NUMPAD1;
-    m_key_map[XK_KP_2] = KC_KEY_NUMPAD2;
-    m_key_map[XK_KP_3] = KC_KEY_NUMPAD3;
-    m_key_map[XK_KP_4] = KC_KEY_NUMPAD4;
-    m_key_map[XK_KP_5] = KC_KEY_NUMPAD5;
-    m_key_map[XK_KP_6] = KC_KEY_NUMPAD6;
-    m_key_map[XK_KP_7] = KC_KEY_NUMPAD7;
-    m_key_map[XK_KP_8] = KC_KEY_NUMPAD8;
-    m_key_map[XK_KP_9] = KC_KEY_NUMPAD9;
-    m_key_map[XK_F1] = KC_KEY_F1;
-    m_key_map[XK_F2] = KC_KEY_F2;
-    m_key_map[XK_F3] = KC_KEY_F3;
-    m_key_map[XK_F4] = KC_KEY_F4;
-    m_key_map[XK_F5] = KC_KEY_F5;
-    m_key_map[XK_F6] = KC_KEY_F6;
-    m_key_map[XK_F7] = KC_KEY_F7;
-    m_key_map[XK_F8] = KC_KEY_F8;
-    m_key_map[XK_F9] = KC_KEY_F9;
-    m_key_map[XK_F10] = KC_KEY_F10;
-    m_key_map[XK_F11] = KC_KEY_F11;
-    m_key_map[XK_F12] = KC_KEY_F12;
-    m_key_map[XK_Shift_L] = KC_KEY_LSHIFT;
-    m_key_map[XK_Shift_R] = KC_KEY_RSHIFT;
-    m_key_map[XK_Control_L] = KC_KEY_LCONTROL;
-    m_key_map[XK_Control_R] = KC_KEY_RCONTROL;
-    m_key_map[XK_Caps_Lock] = KC_KEY_CAPITAL;
-    m_key_map[XK_Shift_Lock] = KC_KEY_CAPITAL;
-    m_key_map[XK_Meta_L] = KC_KEY_LWIN;
-    m_key_map[XK_Meta_R] = KC_KEY_RWIN;
-    m_key_map[XK_Alt_L] = KC_KEY_LMENU;
-    m_key_map[XK_Alt_R] = KC_KEY_RMENU;
-    m_key_map[XK_ISO_Level3_Shift] = KC_KEY_RMENU;
-    m_key_map[XK_Menu] = KC_KEY_MENU;
-    m_key_map[XK_space] = KC_KEY_SPACE;
-    m_key_map[XK_exclam] = KC_KEY_UNKNOWN;
-    m_key_map[XK_quotedbl] = KC_KEY_UNKNOWN;
-    m_key_map[XK_section] = KC_KEY_UNKNOWN;
-    m_key_map[XK_numbersign] = KC_KEY_OEM_2;
-    m_key_map[XK_dollar] = KC_KEY_UNKNOWN;
-    m_key_map[XK_percent] = KC_KEY_UNKNOWN;
-    m_key_map[XK_ampersand] = KC_KEY_UNKNOWN;
-    m_key_map[XK_apostrophe] = KC_KEY_OEM_7;
-    m_key_map[XK_parenleft] = KC_KEY_UNKNOWN;
-    m_key_map[XK_parenright] = KC_KEY_UNKNOWN;
-    m_key_map[XK_asterisk] = KC_KEY_UNKNOWN;
-    m_key_map[XK_plus] = KC_KEY_PLUS;
-    m_key_map[XK_comma] = KC_KEY_COMMA;
-    m_key_map[XK_minus] = KC_KEY_MINUS;
-    m_key_map[XK_period] = KC_KEY_PERIOD;
-    m_key_map[XK_slash] = KC_KEY_OEM_2;
-    m_key_map[XK_0] = KC_KEY_0;
-    m_key_map[XK_1] = KC_KEY_1;
-    m_key_map[XK_2] = KC_KEY_2;
-    m_key_map[XK_3] = KC_KEY_3;
-    m_key_map[XK_4] = KC_KEY_4;
-    m_key_map[XK_5] = KC_KEY_5;
-    m_key_map[XK_6] = KC_KEY_6;
-    m_key_map[XK_7] = KC_KEY_7;
-    m_key_map[XK_8] = KC_KEY_8;
-    m_key_map[XK_9] = KC_KEY_9;
-    m_key_map[XK_colon] = KC_KEY_UNKNOWN;
-    m_key_map[XK_semicolon] = KC_KEY_OEM_1;
-    m_key_map[XK_less] = KC_KEY_OEM_102;
-    m_key_map[XK_equal] = KC_KEY_PLUS;
-    m_key_map[XK_greater] = KC_KEY_UNKNOWN;
-    m_key_map[XK_question] = KC_KEY_UNKNOWN;
-    m_key_map[XK_at] = KC_KEY_2;
-    m_key_map[XK_mu] = KC_KEY_UNKNOWN;
-    m_key_map[XK_EuroSign] = KC_KEY_UNKNOWN;
-    m_key_map[XK_A] = KC_KEY_A;
-    m_key_map[XK_B] = KC_KEY_B;
-    m_key_map[XK_C] = KC_KEY_C;
-    m_key_map[XK_D] = KC_KEY_D;
-    m_key_map[XK_E] = KC_KEY_E;
-    m_key_map[XK_F] = KC_KEY_F;
-    m_key_map[XK_G] = KC_KEY_G;
-    m_key_map[XK_H] = KC_KEY_H;
-    m_key_map[XK_I] = KC_KEY_I;
-    m_key_map[XK_J] = KC_KEY_J;
-    m_key_map[XK_K] = KC_KEY_K;
-    m_key_map[XK_L] = KC_KEY_L;
-    m_key_map[XK_M] = KC_KEY_M;
-    m_key_map[XK_N] = KC_KEY_N;
-    m_key_map[XK_O] = KC_KEY_O;
-    m_key_map[XK_P] = KC_KEY_P;
-    m_key_map[XK_Q] = KC_KEY_Q;
-    m_key_map[XK_R] = KC_KEY_R;
-    m_key_map[XK_S] = KC_KEY_S;
-    m_key_map[XK_T] = KC_KEY_T;
-    m_key_map[XK_U] = KC_KEY_U;
-    m_key_map[XK_V] = KC_KEY_V;
-    m_key_map[XK_W] = KC_KEY_W;
-    m_key_map[XK_X] = KC_KEY_X;
-    m_key_map[XK_Y] = KC_KEY_Y;
-    m_key_map[XK_Z] = KC_KEY_Z;
-    m_key_map[XK_bracketleft] = KC_KEY_OEM_4;
-    m_key_map[XK_backslash] = KC_KEY_OEM_5;
-    m_key_map[XK_bracketright] = KC_KEY_OEM_6;
-    m_key_map[XK_asciicircum] = KC_KEY_OEM_5;
-    m_key_map[XK_degree] = KC_KEY_UNKNOWN;
-    m_key_map[XK_underscore] = KC_KEY_MINUS;
-    m_key_map[XK_grave] = KC_KEY_OEM_3;
-    m_key_map[XK_acute] = KC_KEY_OEM_6;
-    m_key_map[XK_a] = KC_KEY_A;
-    m_key_map[XK_b] = KC_KEY_B;
-    m_key_map[XK_c] = KC_KEY_C;
-    m_key_map[XK_d] = KC_KEY_D;
-    m_key_map[XK_e] = KC_KEY_E;
-    m_key_map[XK_f] = KC_KEY_F;
-    m_key_map[XK_g] = KC_KEY_G;
-    m_key_map[XK_h] = KC_KEY_H;
-    m_key_map[XK_i] = KC_KEY_I;
-    m_key_map[XK_j] = KC_KEY_J;
-    m_key_map[XK_k] = KC_KEY_K;
-    m_key_map[XK_l] = KC_KEY_L;
-    m_key_map[XK_m] = KC_KEY_M;
-    m_key_map[XK_n] = KC_KEY_N;
-    m_key_map[XK_o] = KC_KEY_O;
-    m_key_map[XK_p] = KC_KEY_P;
-    m_key_map[XK_q] = KC_KEY_Q;
-    m_key_map[XK_r] = KC_KEY_R;
-    m_key_map[XK_s] = KC_KEY_S;
-    m_key_map[XK_t] = KC_KEY_T;
-    m_key_map[XK_u] = KC_KEY_U;
-    m_key_map[XK_v] = KC_KEY_V;
-    m_key_map[XK_w] = KC_KEY_W;
-    m_key_map[XK_x] = KC_KEY_X;
-    m_key_map[XK_y] = KC_KEY_Y;
-    m_key_map[XK_z] = KC_KEY_Z;
-    m_key_map[XK_ssharp] = KC_KEY_OEM_4;
-    m_key_map[XK_adiaeresis] = KC_KEY_OEM_7;
-    m_key_map[XK_odiaeresis] = KC_KEY_OEM_3;
-    m_key_map[XK_udiaeresis] = KC_KEY_OEM_1;
-    m_key_map[XK_Super_L] = KC_KEY_LWIN;
-    m_key_map[XK_Super_R] = KC_KEY_RWIN;
-}
-
-bool DeviceLinux::processEvents()
+bool DeviceLinux::processEvents(int timeout_ms)
 {
     if (!m_display)
         return false;
 
+    // The clipboard request is cancelled when the owner doesn't respond, so
+    // the wait can't be longer than that
+    if (timeout_ms != 0 && !m_clipboard_callbacks.empty())
+    {
+        unsigned long now = getMicroTickCount();
+        int remaining_ms = 0;
+        
+        if (m_clipboard_deadline > now)
+        {
+            remaining_ms = (m_clipboard_deadline - now) / 1000 + 1;
+        }
+        
+        if (timeout_ms < 0 || remaining_ms < timeout_ms)
+        {
+            timeout_ms = remaining_ms;
+        }
+    }
+
+    // Joysticks and hotplug are handled in the same wait, so that there is 
+    // nothing to read when they are idle
+    if (timeout_ms != 0 && (m_close || hasPendingXEvents()))
+    {
+        timeout_ms = 0;
+    }
+    
+    waitForEvents(timeout_ms);
+    
+#ifndef __CYGWIN__
+    // Cleared before the queue is drained, so that events pushed from now on
+    // wake up the next wait
+    if (m_input_thread_active)
+    {
+        uint64_t value = 0;
+        ssize_t ret = read(m_input_event_fd, &value, sizeof(value));
+        (void)ret;
+    }
+#endif
+
     Event event;
+    
+    // Pointer motions that come one after another are merged, so that only 
+    // the latest position goes to the scene
+    Event motion_event;
+    bool motion_pending = false;
+
+    XEvent xevent;
+    unsigned long event_time = 0;
 
-    while (XPending(m_display) > 0 && !m_close)
+    while (!m_close && nextXEvent(xevent, event_time))
     {
-        XEvent xevent;
-        XNextEvent(m_display, &xevent);
+        if (motion_pending && xevent.type != MotionNotify)
+        {
+            sendEvent(motion_event);
+            motion_pending = false;
+        }
+        
+        m_event_time = event_time;
 
         switch (xevent.type)
         {
         case ConfigureNotify:
-            m_window_width = xevent.xconfigure.width;
-            m_window_height = xevent.xconfigure.height;
+            if (m_window_width != (unsigned int)xevent.xconfigure.width ||
+                m_window_height != (unsigned int)xevent.xconfigure.height)
+            {
+                m_window_width = xevent.xconfigure.width;
+                m_window_height = xevent.xconfigure.height;
+                requestRedraw();
+            }
+            break;
+
+        case Expose:
+            requestRedraw();
             break;
 
         case MapNotify:
             m_window_minimized = false;
+            requestRedraw();
             break;
 
         case UnmapNotify:
@@ -917,17 +1055,20 @@ bool DeviceLinux::processEvents()
             break;
 
         case MotionNotify:
-            event.type = ET_MOUSE_EVENT;
-            event.mouse.type = ME_MOUSE_MOVED;
-            event.mouse.x = xevent.xbutton.x;
-            event.mouse.y = xevent.xbutton.y;
-            event.mouse.control = (xevent.xkey.state & ControlMask);
-            event.mouse.shift = (xevent.xkey.state & ShiftMask);
-            event.mouse.button_state_left = (xevent.xbutton.state & Button1Mask);
-            event.mouse.button_state_right = (xevent.xbutton.state & Button3Mask);
-            event.mouse.button_state_middle = (xevent.xbutton.state & Button2Mask);
-
-            sendEvent(event);
+            motion_event.type = ET_MOUSE_EVENT;
+            motion_event.mouse.type = ME_MOUSE_MOVED;
+            motion_event.mouse.x = xevent.xmotion.x;
+            motion_event.mouse.y = xevent.xmotion.y;
+            motion_event.mouse.wheel = 0.0f;
+            motion_event.mouse.control = (xevent.xmotion.state & ControlMask);
+            motion_event.mouse.shift = (xevent.xmotion.state & ShiftMask);
+            motion_event.mouse.button_state_left = 
+                                        (xevent.xmotion.state & Button1Mask);
+            motion_event.mouse.button_state_right = 
+                                        (xevent.xmotion.state & Button3Mask);
+            motion_event.mouse.button_state_middle = 
+                                        (xevent.xmotion.state & Button2Mask);
+            motion_pending = true;
             break;
 
         case ButtonPress:
@@ -1009,18 +1150,11 @@ bool DeviceLinux::processEvents()
             break;
 
         case KeyRelease:
-            if (XPending(m_display) > 0)
-            {
-                XEvent next_event;
-                XPeekEvent(xevent.xkey.display, &next_event);
-
-                if ((next_event.type == KeyPress) &&
-                    (next_event.xkey.keycode == xevent.xkey.keycode) &&
-                    (next_event.xkey.time - xevent.xkey.time) < 2)
-                {
-                    break;
-                }
-            }
+        {
+            // Releases from auto repeat are already dropped by the input
+            // thread, which sees the Xlib queue before the events are passed
+            if (!m_input_thread_active && isKeyRepeat(xevent))
+                break;
 
             event.type = ET_KEY_EVENT;
             event.key.pressed = false;
@@ -1030,6 +1164,7 @@ bool DeviceLinux::processEvents()
             event.key.id = getKeyCode(xevent);
 
             sendEvent(event);
+        }
             break;
 
         case KeyPress:
@@ -1072,6 +1207,14 @@ bool DeviceLinux::processEvents()
         }
             break;
 
+        case SelectionNotify:
+            onSelectionNotify(xevent.xselection);
+            break;
+
+        case PropertyNotify:
+            onPropertyNotify(xevent.xproperty);
+            break;
+
         case SelectionRequest:
         {
             XEvent respond;
@@ -1113,15 +1256,274 @@ bool DeviceLinux::processEvents()
             break;
         }
     }
-
-    if (!m_close)
+    
+    if (motion_pending && !m_close)
+    {
+        sendEvent(motion_event);
+    }
+    
+    if (!m_clipboard_callbacks.empty() && 
+        getMicroTickCount() > m_clipboard_deadline)
     {
-        pollJoysticks();
+        printf("Warning: Clipboard owner didn't respond.\n");
+        finishClipboardRequest(false);
     }
 
     return !m_close;
 }
 
+// The X connection, joysticks and the hotplug watch are all in a single
+// epoll set, so the wait doesn't depend on the number of devices. When the
+// input thread reads the X connection, its event fd is watched instead.
+void DeviceLinux::initInputReactor()
+{
+#ifndef __CYGWIN__
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    
+    if (m_epoll_fd == -1)
+    {
+        printf("Warning: Couldn't create epoll instance.\n");
+        return;
+    }
+    
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = m_input_thread_active ? m_input_event_fd 
+                                          : ConnectionNumber(m_display);
+    
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, event.data.fd, &event) == -1)
+    {
+        printf("Warning: Couldn't watch X server connection.\n");
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+#endif
+}
+
+void DeviceLinux::closeInputReactor()
+{
+#ifndef __CYGWIN__
+    if (m_inotify_fd != -1)
+    {
+        close(m_inotify_fd);
+        m_inotify_fd = -1;
+    }
+    
+    if (m_epoll_fd != -1)
+    {
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+#endif
+}
+
+// Blocks until the X server connection, some joystick or the hotplug watch
+// becomes readable. Joysticks and hotplug are handled here, and X events 
+// are left for the processEvents loop.
+void DeviceLinux::waitForEvents(int timeout_ms)
+{
+    if (timeout_ms != 0)
+    {
+        XFlush(m_display);
+    }
+
+#ifndef __CYGWIN__
+    if (m_epoll_fd != -1)
+    {
+        // X events are checked with XPending anyway
+        if (timeout_ms == 0 && m_active_joysticks.empty() && 
+            m_inotify_fd == -1)
+            return;
+        
+        struct epoll_event events[INPUT_MAX_EVENTS];
+        int count = epoll_wait(m_epoll_fd, events, INPUT_MAX_EVENTS, 
+                               timeout_ms);
+        
+        for (int i = 0; i < count; i++)
+        {
+            int fd = events[i].data.fd;
+            m_event_time = getMicroTickCount();
+            
+            if (fd == m_inotify_fd)
+            {
+                readHotplugEvents();
+            }
+            else if (fd != ConnectionNumber(m_display) && 
+                     fd != m_input_event_fd)
+            {
+                readJoystick(fd, events[i].events);
+            }
+        }
+        
+        return;
+    }
+#endif
+
+    if (timeout_ms == 0)
+        return;
+
+    struct pollfd x11_fd;
+    x11_fd.fd = m_input_thread_active ? m_input_event_fd 
+                                      : ConnectionNumber(m_display);
+    x11_fd.events = POLLIN;
+    x11_fd.revents = 0;
+
+    poll(&x11_fd, 1, timeout_ms);
+}
+
+// The X connection is shared with the main thread, which still sends
+// requests and handles the events
+bool DeviceLinux::startInputThread()
+{
+#ifndef __CYGWIN__
+    m_input_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    
+    if (m_input_event_fd == -1)
+        return false;
+    
+    m_atom_input_wakeup = XInternAtom(m_display, "INPUT_THREAD_WAKEUP", False);
+    m_input_thread_stop = false;
+    m_input_thread = std::thread(&DeviceLinux::runInputThread, this);
+    m_input_thread_active = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DeviceLinux::stopInputThread()
+{
+#ifndef __CYGWIN__
+    if (!m_input_thread_active)
+        return;
+    
+    // The thread is blocked in XNextEvent, so it's woken up with a message
+    // sent to our own window
+    m_input_thread_stop = true;
+    
+    XEvent event;
+    memset(&event, 0, sizeof(event));
+    event.xclient.type = ClientMessage;
+    event.xclient.window = m_window;
+    event.xclient.message_type = m_atom_input_wakeup;
+    event.xclient.format = 32;
+    
+    XSendEvent(m_display, m_window, False, NoEventMask, &event);
+    XFlush(m_display);
+    
+    m_input_thread.join();
+    m_input_thread_active = false;
+    
+    close(m_input_event_fd);
+    m_input_event_fd = -1;
+#endif
+}
+
+// Reads X events as soon as they arrive, so that their time doesn't depend
+// on how long the current frame takes. Xlib is initialized for threads, so 
+// XNextEvent can wait here while the main thread sends requests.
+void DeviceLinux::runInputThread()
+{
+#ifndef __CYGWIN__
+    while (true)
+    {
+        XEventRecord record;
+        XNextEvent(m_display, &record.event);
+        record.time = getMicroTickCount();
+        
+        if (record.event.type == ClientMessage &&
+            record.event.xclient.message_type == m_atom_input_wakeup)
+        {
+            if (m_input_thread_stop)
+                break;
+            
+            continue;
+        }
+        
+        // The press that follows the release may not be in our queue yet, so
+        // auto repeat must be detected here and not in processEvents
+        if (record.event.type == KeyRelease && isKeyRepeat(record.event))
+            continue;
+        
+        // Events are not dropped when the main thread is stuck in a long
+        // frame, the thread just waits for a free slot
+        while (!m_input_queue.push(record))
+        {
+            if (m_input_thread_stop)
+                return;
+            
+            sleep(1);
+        }
+        
+        uint64_t value = 1;
+        ssize_t ret = write(m_input_event_fd, &value, sizeof(value));
+        (void)ret;
+    }
+#endif
+}
+
+bool DeviceLinux::hasPendingXEvents()
+{
+    if (m_input_thread_active)
+        return !m_input_queue.isEmpty();
+    
+    return XPending(m_display) > 0;
+}
+
+static bool isInputEventType(int type)
+{
+    return type == ButtonPress || type == ButtonRelease || 
+           type == MotionNotify || type == KeyPress || type == KeyRelease;
+}
+
+// Takes the next event from the input thread queue, or directly from Xlib
+// when there is no input thread
+bool DeviceLinux::nextXEvent(XEvent& xevent, unsigned long& time)
+{
+    if (!m_input_thread_active)
+    {
+        if (XPending(m_display) == 0)
+            return false;
+        
+        XNextEvent(m_display, &xevent);
+        time = getMicroTickCount();
+        return true;
+    }
+    
+    XEventRecord record;
+    
+    while (m_input_queue.pop(record))
+    {
+        // Input that was already in the queue when clearSystemMessages was
+        // called is skipped
+        if (record.time <= m_input_clear_time && 
+            isInputEventType(record.event.type))
+            continue;
+        
+        xevent = record.event;
+        time = record.time;
+        return true;
+    }
+    
+    return false;
+}
+
+// Auto repeat sends a release that is immediately followed by a press of the
+// same key. The release is ignored, so that a held key isn't released.
+bool DeviceLinux::isKeyRepeat(const XEvent& xevent)
+{
+    if (XPending(m_display) == 0)
+        return false;
+    
+    XEvent next_event;
+    XPeekEvent(m_display, &next_event);
+    
+    return next_event.type == KeyPress &&
+           next_event.xkey.keycode == xevent.xkey.keycode &&
+           (next_event.xkey.time - xevent.xkey.time) < 2;
+}
+
 void DeviceLinux::setWindowCaption(const char* text)
 {
     XTextProperty txt;
@@ -1251,56 +1653,153 @@ bool DeviceLinux::getWindowPosition(int* x, int* y)
     return true;
 }
 
-std::string DeviceLinux::getClipboardContent()
+// The request is only sent here, and the content is read when the owner
+// answers with SelectionNotify, so that a slow owner can't block the frame
+void DeviceLinux::requestClipboardContent(ClipboardCallback callback)
 {
-    if (m_atom_clipboard == None) 
-        return m_clipboard;
+    if (m_atom_clipboard == None)
+    {
+        callback(m_clipboard);
+        return;
+    }
 
     Window owner_window = XGetSelectionOwner(m_display, m_atom_clipboard);
     
     if (owner_window == None || owner_window == m_window)
-        return m_clipboard;
+    {
+        callback(m_clipboard);
+        return;
+    }
+    
+    m_clipboard_callbacks.push_back(callback);
+    
+    // Callbacks that come before the answer share the same request
+    if (m_clipboard_callbacks.size() > 1)
+        return;
 
-    Atom selection = XInternAtom(m_display, "CLIPBOARD_SELECTION", false);
     XConvertSelection(m_display, m_atom_clipboard, m_atom_utf8_string, 
-                      selection, m_window, CurrentTime);
+                      m_atom_clipboard_property, m_window, CurrentTime);
+    XFlush(m_display);
+    
+    m_clipboard_incr = false;
+    m_clipboard_deadline = getMicroTickCount() + CLIPBOARD_TIMEOUT;
+}
+
+bool DeviceLinux::readClipboardProperty(Atom* type, std::string& data)
+{
+    int format;
+    unsigned long num_items, bytes_after;
+    unsigned char* property = NULL;
+
+    // Deleting the property tells the owner that the next INCR chunk can 
+    // be sent
+    int result = XGetWindowProperty(m_display, m_window, 
+                                    m_atom_clipboard_property, 0, INT_MAX / 4, 
+                                    true, AnyPropertyType, type, &format, 
+                                    &num_items, &bytes_after, &property);
 
-    bool data_ok = false;
+    if (result != Success)
+        return false;
     
-    for (int i = 0; i < 500; i++)
+    data.clear();
+    
+    // Text is always sent in 8 bit items. Xlib returns 32 bit items as long,
+    // so they can't be copied as bytes, but they are used only for the INCR
+    // size estimate, which is not needed.
+    bool valid = (format == 8 || *type == m_atom_incr || *type == None);
+    
+    if (property != NULL)
     {
-        XEvent xevent;
-        bool res = XCheckTypedWindowEvent(m_display, m_window, SelectionNotify, 
-                                          &xevent);
-        
-        if (res && xevent.xselection.selection == m_atom_clipboard)
+        if (format == 8)
         {
-            data_ok = true;
-            break;
+            data.assign((char*)property, num_items);
         }
-
-        sleep(1);
+        
+        XFree(property);
     }
+    
+    return valid;
+}
 
-    if (!data_ok)
-        return "";
-
-    Atom type;
-    int format;
-    unsigned long num_items, dummy;
-    char* data = NULL;
-
-    int result = XGetWindowProperty(m_display, m_window, selection, 0, INT_MAX/4, 
-                                    false, AnyPropertyType, &type, &format, 
-                                    &num_items, &dummy, (unsigned char**)&data);
+void DeviceLinux::onSelectionNotify(const XSelectionEvent& event)
+{
+    if (m_clipboard_callbacks.empty() || m_clipboard_incr ||
+        event.selection != m_atom_clipboard)
+        return;
+    
+    if (event.property == None)
+    {
+        finishClipboardRequest(false);
+        return;
+    }
+    
+    Atom type = None;
+    
+    if (!readClipboardProperty(&type, m_clipboard_data))
+    {
+        finishClipboardRequest(false);
+        return;
+    }
+    
+    // Large selections are sent in chunks, which come as property changes
+    if (type == m_atom_incr)
+    {
+        m_clipboard_incr = true;
+        m_clipboard_data.clear();
+        m_clipboard_deadline = getMicroTickCount() + CLIPBOARD_TIMEOUT;
+        return;
+    }
+    
+    finishClipboardRequest(true);
+}
 
-    if (result == Success)
+void DeviceLinux::onPropertyNotify(const XPropertyEvent& event)
+{
+    if (!m_clipboard_incr || event.atom != m_atom_clipboard_property ||
+        event.state != PropertyNewValue)
+        return;
+    
+    Atom type = None;
+    std::string chunk;
+    
+    if (!readClipboardProperty(&type, chunk))
     {
-        m_clipboard = data;
-        XFree(data);
+        finishClipboardRequest(false);
+        return;
     }
+    
+    // Empty chunk means the end of the transfer
+    if (chunk.empty())
+    {
+        finishClipboardRequest(true);
+        return;
+    }
+    
+    m_clipboard_data += chunk;
+    m_clipboard_deadline = getMicroTickCount() + CLIPBOARD_TIMEOUT;
+}
 
-    return m_clipboard;
+void DeviceLinux::finishClipboardRequest(bool success)
+{
+    std::string text;
+    
+    if (success)
+    {
+        m_clipboard = m_clipboard_data;
+        text = m_clipboard;
+    }
+    
+    m_clipboard_data.clear();
+    m_clipboard_incr = false;
+    
+    // Callbacks may request the content again
+    std::vector<ClipboardCallback> callbacks;
+    callbacks.swap(m_clipboard_callbacks);
+    
+    for (ClipboardCallback& callback : callbacks)
+    {
+        callback(text);
+    }
 }
 
 void DeviceLinux::setClipboardContent(std::string text)
@@ -1317,6 +1816,13 @@ Bool isEventType(Display* display, XEvent* event, XPointer arg)
 
 void DeviceLinux::clearSystemMessages()
 {
+    m_input_clear_time = getMicroTickCount();
+    
+    // The input thread reads all events, so the queued input is skipped by
+    // its time in nextXEvent
+    if (m_input_thread_active)
+        return;
+    
     std::array<int, 5> args = {ButtonPress, ButtonRelease, MotionNotify, 
                                KeyRelease, KeyPress};
 
@@ -1405,88 +1911,232 @@ void DeviceLinux::activateJoysticks()
 #ifndef __CYGWIN__
     for (unsigned int i = 0; i < 32; i++)
     {
-        JoystickInfo joystick_info;
-        joystick_info.id = i;
-
-        std::string device_name = "/dev/js" + std::to_string(i);
-        joystick_info.fd = open(device_name.c_str(), O_RDONLY);
+        std::string id = std::to_string(i);
         
-        if (joystick_info.fd == -1)
-        {
-            device_name = "/dev/input/js" + std::to_string(i);
-            joystick_info.fd = open(device_name.c_str(), O_RDONLY);
-        }
+        if (openJoystick("/dev/js" + id, i))
+            continue;
+            
+        if (openJoystick("/dev/input/js" + id, i))
+            continue;
+            
+        openJoystick("/dev/joy" + id, i);
+    }
+    
+    if (m_epoll_fd == -1)
+        return;
+    
+    // Device node is created before udev sets its permissions, so it's 
+    // opened again when the attributes change
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    
+    if (m_inotify_fd == -1)
+        return;
         
-        if (joystick_info.fd == -1)
-        {
-            device_name = "/dev/joy" + std::to_string(i);
-            joystick_info.fd = open(device_name.c_str(), O_RDONLY);
-        }
+    int watch = inotify_add_watch(m_inotify_fd, "/dev/input", 
+                                  IN_CREATE | IN_ATTRIB | IN_DELETE);
+    
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = m_inotify_fd;
+    
+    if (watch == -1 || 
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_inotify_fd, &event) == -1)
+    {
+        printf("Warning: Joystick hotplug is not available.\n");
+        close(m_inotify_fd);
+        m_inotify_fd = -1;
+    }
+#endif
+}
 
-        if (joystick_info.fd == -1)
-            continue;
+bool DeviceLinux::openJoystick(const std::string& path, int id)
+{
+#ifndef __CYGWIN__
+    for (JoystickInfo& info : m_active_joysticks)
+    {
+        if (info.path == path)
+            return true;
+    }
+    
+    JoystickInfo joystick_info;
+    joystick_info.id = id;
+    joystick_info.path = path;
+    joystick_info.fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
 
-        ioctl(joystick_info.fd, JSIOCGAXES, &(joystick_info.axes));
-        ioctl(joystick_info.fd, JSIOCGBUTTONS, &(joystick_info.buttons));
-        fcntl(joystick_info.fd, F_SETFL, O_NONBLOCK);
+    if (joystick_info.fd == -1)
+        return false;
 
-        char name[80];
-        ioctl(joystick_info.fd, JSIOCGNAME(80), name);
-        joystick_info.name = name;
-        
-        memset(&joystick_info.data, 0, sizeof(joystick_info.data));
-        joystick_info.data.id = joystick_info.id;
-        
-        m_active_joysticks.push_back(joystick_info);
+    ioctl(joystick_info.fd, JSIOCGAXES, &(joystick_info.axes));
+    ioctl(joystick_info.fd, JSIOCGBUTTONS, &(joystick_info.buttons));
+
+    char name[80] = {0};
+    ioctl(joystick_info.fd, JSIOCGNAME(80), name);
+    joystick_info.name = name;
+    
+    if (m_epoll_fd != -1)
+    {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = joystick_info.fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, joystick_info.fd, &event);
     }
+    
+    m_active_joysticks.push_back(joystick_info);
+    
+    Event event;
+    event.type = ET_JOYSTICK_EVENT;
+    event.joystick.type = JE_CONNECTED;
+    event.joystick.id = id;
+    event.joystick.number = 0;
+    event.joystick.value = 0;
+    sendEvent(event);
+    
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DeviceLinux::closeJoystick(unsigned int index)
+{
+#ifndef __CYGWIN__
+    JoystickInfo& info = m_active_joysticks[index];
+    
+    // Closing the fd removes it from the epoll set
+    close(info.fd);
+    
+    Event event;
+    event.type = ET_JOYSTICK_EVENT;
+    event.joystick.type = JE_DISCONNECTED;
+    event.joystick.id = info.id;
+    event.joystick.number = 0;
+    event.joystick.value = 0;
+    
+    m_active_joysticks.erase(m_active_joysticks.begin() + index);
+    
+    sendEvent(event);
 #endif
 }
 
-void DeviceLinux::pollJoysticks()
+void DeviceLinux::readJoystick(int fd, unsigned int poll_events)
 {
 #ifndef __CYGWIN__
-    if (m_active_joysticks.empty())
+    unsigned int index = 0;
+    
+    while (index < m_active_joysticks.size() && 
+           m_active_joysticks[index].fd != fd)
+    {
+        index++;
+    }
+    
+    if (index == m_active_joysticks.size())
         return;
 
+    JoystickInfo& joystick_info = m_active_joysticks[index];
     bool event_received = false;
     
-    for (JoystickInfo& joystick_info : m_active_joysticks)
+    Event event;
+    event.type = ET_JOYSTICK_EVENT;
+    event.joystick.id = joystick_info.id;
+    
+    struct js_event evts[32];
+    ssize_t length;
+    
+    while ((length = read(fd, evts, sizeof(evts))) > 0)
     {
-        struct js_event evt;
+        int count = length / sizeof(struct js_event);
         
-        while (read(joystick_info.fd, &evt, sizeof(evt)) == sizeof(evt))
+        for (int i = 0; i < count; i++)
         {
+            const struct js_event& evt = evts[i];
+            
             if (evt.number >= 32)
                 continue;
             
             switch (evt.type & ~JS_EVENT_INIT)
             {
             case JS_EVENT_BUTTON:
-                event_received = true;
-                joystick_info.data.button_states[evt.number] = evt.value;
+                if (joystick_info.button_states[evt.number] == (evt.value != 0))
+                    continue;
+                    
+                joystick_info.button_states[evt.number] = evt.value;
+                event.joystick.type = JE_BUTTON;
                 break;
                 
             case JS_EVENT_AXIS:
-                event_received = true;
-                joystick_info.data.axis[evt.number] = evt.value;
+                if (joystick_info.axis[evt.number] == evt.value)
+                    continue;
+                    
+                joystick_info.axis[evt.number] = evt.value;
+                event.joystick.type = JE_AXIS;
                 break;
                 
             default:
-                break;
+                continue;
             }
+            
+            event.joystick.number = evt.number;
+            event.joystick.value = evt.value;
+            event_received = true;
+            
+            sendEvent(event);
         }
-        
-        Event event;
-        event.type = ET_JOYSTICK_EVENT;
-        event.joystick = joystick_info.data;
-
-        sendEvent(event);
     }
     
     if (event_received)
     {
         XResetScreenSaver(m_display);
     }
+    
+    // Unplugged device can't be read anymore
+    if ((length == -1 && errno != EAGAIN) || 
+        (poll_events & (EPOLLHUP | EPOLLERR)))
+    {
+        closeJoystick(index);
+    }
+#endif
+}
+
+void DeviceLinux::readHotplugEvents()
+{
+#ifndef __CYGWIN__
+    char buffer[4096] 
+                __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    
+    while ((length = read(m_inotify_fd, buffer, sizeof(buffer))) > 0)
+    {
+        char* ptr = buffer;
+        
+        while (ptr < buffer + length)
+        {
+            const struct inotify_event* event = (struct inotify_event*)ptr;
+            ptr += sizeof(struct inotify_event) + event->len;
+            
+            if (event->len == 0 || strncmp(event->name, "js", 2) != 0)
+                continue;
+            
+            std::string path = std::string("/dev/input/") + event->name;
+            
+            if (event->mask & IN_DELETE)
+            {
+                for (unsigned int i = 0; i < m_active_joysticks.size(); i++)
+                {
+                    if (m_active_joysticks[i].path == path)
+                    {
+                        closeJoystick(i);
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                openJoystick(path, atoi(event->name + 2));
+            }
+        }
+    }
 #endif
 }
 
@@ -20,10 +20,22 @@
 #if (defined(__linux__) || defined(__CYGWIN__)) && !defined(ANDROID)
 
 #include "device.hpp"
+#include "spsc_queue.hpp"
 
+#include <atomic>
+#include <thread>
 #include <X11/Xlib.h>
 #include <X11/extensions/Xrandr.h>
 
+#define INPUT_QUEUE_SIZE 256
+
+// X event together with the time when the input thread received it
+struct XEventRecord
+{
+    XEvent event;
+    unsigned long time;
+};
+
 class DeviceLinux : public Device
 {
 private:
@@ -42,6 +54,13 @@ private:
     Atom m_atom_clipboard;
     Atom m_atom_targets;
     Atom m_atom_utf8_string;
+    Atom m_atom_clipboard_property;
+    Atom m_atom_incr;
+    
+    std::vector<ClipboardCallback> m_clipboard_callbacks;
+    std::string m_clipboard_data;
+    bool m_clipboard_incr;
+    unsigned long m_clipboard_deadline;
     
     RROutput m_output_id;
     RRMode m_default_mode;
@@ -52,7 +71,17 @@ private:
     XIM m_input_method;
     XIC m_input_context;
     int m_numlock_mask;
-    std::map<int, KeyId> m_key_map;
+
+    int m_epoll_fd;
+    int m_inotify_fd;
+    
+    SPSCQueue<XEventRecord, INPUT_QUEUE_SIZE> m_input_queue;
+    std::thread m_input_thread;
+    std::atomic<bool> m_input_thread_stop;
+    bool m_input_thread_active;
+    int m_input_event_fd;
+    Atom m_atom_input_wakeup;
+    unsigned long m_input_clear_time;
 
     Cursor m_cursor_invisible;
     bool m_cursor_is_visible;
@@ -70,23 +99,41 @@ private:
     bool createInputContext();
     void destroyInputContext();
     void findNumlockMask();
-    void createKeyMap();
     KeyId getKeyCode(XEvent &event);
     
     void initCursor();
     void closeCursor();
     
+    void initInputReactor();
+    void closeInputReactor();
+    void waitForEvents(int timeout_ms);
+    
+    bool startInputThread();
+    void stopInputThread();
+    void runInputThread();
+    bool hasPendingXEvents();
+    bool nextXEvent(XEvent& xevent, unsigned long& time);
+    bool isKeyRepeat(const XEvent& xevent);
+    
     void activateJoysticks();
-    void pollJoysticks();
+    bool openJoystick(const std::string& path, int id);
+    void closeJoystick(unsigned int index);
+    void readJoystick(int fd, unsigned int poll_events);
+    void readHotplugEvents();
     void closeJoysticks();
     
+    void onSelectionNotify(const XSelectionEvent& event);
+    void onPropertyNotify(const XPropertyEvent& event);
+    bool readClipboardProperty(Atom* type, std::string& data);
+    void finishClipboardRequest(bool success);
+    
 public:
     DeviceLinux();
     ~DeviceLinux();
     
     bool initDevice(const CreationParams& creation_params);
     void closeDevice() {m_close = true;}
-    bool processEvents();
+    bool processEvents(int timeout_ms);
     void clearSystemMessages();
     
     void setWindowCaption(const char* text);
@@ -102,7 +149,8 @@ public:
     void setWindowMinimized();
     void setWindowMaximized();
     
-    std::string getClipboardContent();
+    std::string getClipboardContent() {return m_clipboard;}
+    void requestClipboardContent(ClipboardCallback callback);
     void setClipboardContent(std::string text);
 
     void setCursorVisible(bool visible);
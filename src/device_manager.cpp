@@ -15,6 +15,7 @@
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "device_android.hpp"
+#include "device_headless.hpp"
 #include "device_linux.hpp"
 #include "device_manager.hpp"
 
@@ -45,7 +46,7 @@ DeviceManager::~DeviceManager()
     delete m_device;
 }
 
-bool DeviceManager::init()
+bool DeviceManager::init(bool headless)
 {
     CreationParams params;
     params.window_width = 800;
@@ -61,13 +62,21 @@ bool DeviceManager::init()
     params.private_data = NULL;
 #endif
     params.joystick_support = false;
+    params.input_thread = true;
     params.driver_type = DRIVER_OPENGL_ES;
     
+    if (headless)
+    {
+        m_device = new DeviceHeadless();
+    }
+    else
+    {
 #ifdef ANDROID
-    m_device = new DeviceAndroid();
+        m_device = new DeviceAndroid();
 #else
-    m_device = new DeviceLinux();
+        m_device = new DeviceLinux();
 #endif
+    }
     
     bool success = m_device->initDevice(params);
     
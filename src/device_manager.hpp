@@ -29,7 +29,7 @@ public:
     DeviceManager();
     ~DeviceManager();
     
-    bool init();
+    bool init(bool headless = false);
     Device* getDevice() {return m_device;}
     void printDeviceInfo();
     
@@ -16,6 +16,12 @@
 
 #include "device_manager.hpp"
 #include "draw_utils.hpp"
+#include "gl_state.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 bool DrawTextProgram::create()
 {
@@ -36,23 +42,51 @@ bool DrawTextProgram::create()
     if (!success)
         return false;
 
+    success = assignUniform(m_offset, "offset");
+    if (!success)
+        return false;
+
     return true;
 }
 
-bool DrawTextureProgram::create()
+bool SpriteProgram::create()
 {
+    setAttribLocation("coord", SA_COORD);
+    setAttribLocation("color", SA_COLOR);
+    
     bool success = init("draw_texture.vert", "draw_texture.frag");
     
     if (!success)
         return false;
 
-    success = assignAttrib(m_coord, "coord");
+    success = assignUniform(m_tex, "tex");
+    if (!success)
+        return false;
+    
+    GLState::getGLState()->useProgram(m_program);
+    m_tex.set(0);
+
+    return true;
+}
+
+bool SpriteInstancedProgram::create()
+{
+    setAttribLocation("corner", IA_CORNER);
+    setAttribLocation("rect", IA_RECT);
+    setAttribLocation("uv", IA_UV);
+    setAttribLocation("color", IA_COLOR);
+    
+    bool success = init("draw_texture_instanced.vert", "draw_texture.frag");
+    
     if (!success)
         return false;
 
     success = assignUniform(m_tex, "tex");
     if (!success)
         return false;
+    
+    GLState::getGLState()->useProgram(m_program);
+    m_tex.set(0);
 
     return true;
 }
@@ -62,16 +96,37 @@ DrawUtils* DrawUtils::m_draw_utils = NULL;
 DrawUtils::DrawUtils()
 {
     m_draw_utils = this;
+    m_vbo = 0;
+    m_ibo = 0;
+    m_quad_vbo = 0;
+    m_instance_vbo = 0;
+    m_instanced_vao = 0;
+    m_instanced = false;
+    m_ring_size = 1024;
+    m_ring_pos = 0;
     m_draw_text = NULL;
-    m_draw_texture = NULL;
 }
 
 DrawUtils::~DrawUtils()
 {
+    GLState* gl_state = GLState::getGLState();
+    gl_state->onBufferDeleted(m_vbo);
+    gl_state->onBufferDeleted(m_ibo);
+    gl_state->onBufferDeleted(m_quad_vbo);
+    gl_state->onBufferDeleted(m_instance_vbo);
+    
     glDeleteBuffers(1, &m_vbo);
+    glDeleteBuffers(1, &m_ibo);
+    glDeleteBuffers(1, &m_quad_vbo);
+    glDeleteBuffers(1, &m_instance_vbo);
+    
+    if (m_instanced_vao != 0)
+    {
+        gl_state->onVertexArrayDeleted(m_instanced_vao);
+        glDeleteVertexArrays(1, &m_instanced_vao);
+    }
     
     delete m_draw_text;
-    delete m_draw_texture;
 }
 
 bool DrawUtils::init()
@@ -79,101 +134,451 @@ bool DrawUtils::init()
     m_draw_text = new DrawTextProgram();
     bool success = m_draw_text->create();
     
-    m_draw_texture = new DrawTextureProgram();
-    success = success && m_draw_texture->create();
+    // Variants that are used by the scene: opaque and tinted textures, and
+    // glyphs
+    success = success && m_sprite_programs.get(0) != NULL;
+    success = success && m_sprite_programs.get(SF_TINT) != NULL;
+    success = success && 
+              m_sprite_programs.get(SF_COVERAGE | SF_TINT) != NULL;
+    
+    GLState* gl_state = GLState::getGLState();
     
     glGenBuffers(1, &m_vbo);
+    gl_state->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, m_ring_size * 4 * sizeof(SpriteVertex), 
+                 NULL, GL_STREAM_DRAW);
+    
+    // Quads are drawn as indexed triangles, so that all quads of a run can
+    // be drawn with a single call
+    std::vector<GLushort> indices(m_ring_size * 6);
+    
+    for (int i = 0; i < m_ring_size; i++)
+    {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 1;
+        indices[i * 6 + 4] = i * 4 + 3;
+        indices[i * 6 + 5] = i * 4 + 2;
+    }
+    
+    glGenBuffers(1, &m_ibo);
+    gl_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort),
+                 &indices[0], GL_STATIC_DRAW);
+    
+    m_sprites.reserve(m_ring_size);
+    
+    if (success && gl_state->hasInstancedArrays())
+    {
+        m_instanced = initInstancing();
+    }
+    
+    if (m_instanced)
+    {
+        m_instances.reserve(m_ring_size);
+    }
+    else
+    {
+        m_vertices.reserve(m_ring_size * 4);
+    }
     
     return success;
 }
 
-
-void DrawUtils::drawText(Texture* texture, int pos_x, int pos_y, 
-                             GLfloat color[4])
+bool DrawUtils::initInstancing()
 {
-    glUseProgram(m_draw_text->getProgram());
-
-    glEnableVertexAttribArray(m_draw_text->m_coord);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glVertexAttribPointer(m_draw_text->m_coord, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glUniform4fv(m_draw_text->m_color, 1, color);
-    glUniform1i(m_draw_text->m_tex, 0);
+    bool success = m_sprite_instanced_programs.get(0) != NULL;
+    success = success && m_sprite_instanced_programs.get(SF_TINT) != NULL;
+    success = success && 
+              m_sprite_instanced_programs.get(SF_COVERAGE | SF_TINT) != NULL;
+    
+    if (!success)
+    {
+        printf("Warning: Instanced drawing is not available\n");
+        return false;
+    }
+    
+    GLState* gl_state = GLState::getGLState();
+    
+    GLfloat corners[4][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+    
+    glGenBuffers(1, &m_quad_vbo);
+    gl_state->bindBuffer(GL_ARRAY_BUFFER, m_quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    
+    glGenBuffers(1, &m_instance_vbo);
+    gl_state->bindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, m_ring_size * sizeof(SpriteInstance), 
+                 NULL, GL_STREAM_DRAW);
+    
+    // The vertex array is used only by the instanced sprites, so that
+    // attrib divisors don't leak to other draw calls
+    glGenVertexArrays(1, &m_instanced_vao);
+    gl_state->bindVertexArray(m_instanced_vao);
+    gl_state->setAttribArrays((1 << IA_CORNER) | (1 << IA_RECT) | 
+                              (1 << IA_UV) | (1 << IA_COLOR));
+    
+    gl_state->bindBuffer(GL_ARRAY_BUFFER, m_quad_vbo);
+    glVertexAttribPointer(IA_CORNER, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    
+    glVertexAttribDivisor(IA_RECT, 1);
+    glVertexAttribDivisor(IA_UV, 1);
+    glVertexAttribDivisor(IA_COLOR, 1);
+    
+    gl_state->bindVertexArray(0);
+    
+    return true;
+}
 
-    glActiveTexture(GL_TEXTURE0);
+void DrawUtils::begin()
+{
+    m_sprites.clear();
+}
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
+void DrawUtils::makeSprite(Texture* texture, SpriteType type, int pos_x, 
+                           int pos_y, int width, int height, 
+                           const float tex_coords[4], const GLfloat color[4],
+                           Sprite& sprite)
+{
     Device* device = DeviceManager::getDeviceManager()->getDevice();
     unsigned int window_w = device->getWindowWidth();
     unsigned int window_h = device->getWindowHeight();
+    
+    sprite.texture = texture;
+    sprite.features = 0;
+    sprite.blend = (type == SPRITE_GLYPH || texture->alpha == TA_BLEND || 
+                    color[3] < 1.0f);
+    
+    if (type == SPRITE_GLYPH)
+    {
+        sprite.features |= SF_COVERAGE;
+    }
+    
+    // Transparent pixels of textures without translucent pixels are dropped
+    // in the shader, which is cheaper than blending the whole quad
+    if (!sprite.blend && texture->alpha == TA_BINARY)
+    {
+        sprite.features |= SF_ALPHA_TEST;
+    }
+    
+    // White color doesn't change anything, so the cheaper variant is used
+    if (color[0] < 1.0f || color[1] < 1.0f || color[2] < 1.0f || 
+        color[3] < 1.0f)
+    {
+        sprite.features |= SF_TINT;
+    }
+    
+    sprite.rect[0] = (float)(pos_x) / window_w * 2.0f - 1.0f;
+    sprite.rect[1] = (float)(pos_y) / window_h * 2.0f - 1.0f;
+    sprite.rect[2] = (float)(width) / window_w * 2.0f;
+    sprite.rect[3] = (float)(height) / window_h * 2.0f;
+    
+    for (int i = 0; i < 4; i++)
+    {
+        float c = std::max(std::min(color[i], 1.0f), 0.0f);
+        sprite.tex_coords[i] = tex_coords[i];
+        sprite.color[i] = (GLubyte)(c * 255.0f + 0.5f);
+    }
+}
 
-    float x = (float)(pos_x) / window_w * 2.0f - 1.0f;
-    float y = (float)(pos_y) / window_h * 2.0f - 1.0f;
-    float w = (float)(texture->width) / window_w * 2.0f;
-    float h = (float)(texture->height) / window_h * 2.0f;
-    float tex_w = texture->tex_w;
-    float tex_h = texture->tex_h;
+void DrawUtils::getSpriteVertices(const Sprite& sprite, 
+                                  SpriteVertex vertices[4])
+{
+    float x = sprite.rect[0];
+    float y = sprite.rect[1];
+    float w = sprite.rect[2];
+    float h = sprite.rect[3];
+    float u0 = sprite.tex_coords[0];
+    float v0 = sprite.tex_coords[1];
+    float u1 = sprite.tex_coords[2];
+    float v1 = sprite.tex_coords[3];
     
-    GLfloat box[4][4] = { {x, -y,         0, 0},
-                          {x + w, -y,     tex_w, 0},
-                          {x, -y - h,     0, tex_h},
-                          {x + w, -y - h, tex_w, tex_h} };
+    GLfloat box[4][4] = { {x, -y,         u0, v0},
+                          {x + w, -y,     u1, v0},
+                          {x, -y - h,     u0, v1},
+                          {x + w, -y - h, u1, v1} };
     
-    glBindTexture(GL_TEXTURE_2D, texture->id);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(box), box, GL_DYNAMIC_DRAW);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    for (int i = 0; i < 4; i++)
+    {
+        memcpy(vertices[i].coord, box[i], sizeof(vertices[i].coord));
+        memcpy(vertices[i].color, sprite.color, sizeof(vertices[i].color));
+    }
+}
+
+void DrawUtils::setSpriteAttribs(GLintptr offset)
+{
+    GLState* gl_state = GLState::getGLState();
+    gl_state->setAttribArrays((1 << SA_COORD) | (1 << SA_COLOR));
     
-    glDisable(GL_BLEND);
-    glDisableVertexAttribArray(m_draw_text->m_coord);
-    glUseProgram(0);
+    glVertexAttribPointer(SA_COORD, 4, GL_FLOAT, GL_FALSE, 
+                          sizeof(SpriteVertex), (void*)offset);
+    glVertexAttribPointer(SA_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                          sizeof(SpriteVertex), 
+                          (void*)(offset + sizeof(GLfloat) * 4));
 }
 
-void DrawUtils::drawTexture2D(Texture* texture, int pos_x, int pos_y, 
-                                  int width, int height)
+void DrawUtils::setInstanceAttribs(GLintptr offset)
 {
-    glUseProgram(m_draw_texture->getProgram());
+    glVertexAttribPointer(IA_RECT, 4, GL_FLOAT, GL_FALSE, 
+                          sizeof(SpriteInstance), (void*)offset);
+    glVertexAttribPointer(IA_UV, 4, GL_FLOAT, GL_FALSE, 
+                          sizeof(SpriteInstance), 
+                          (void*)(offset + sizeof(GLfloat) * 4));
+    glVertexAttribPointer(IA_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                          sizeof(SpriteInstance), 
+                          (void*)(offset + sizeof(GLfloat) * 8));
+}
 
-    glEnableVertexAttribArray(m_draw_texture->m_coord);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glVertexAttribPointer(m_draw_texture->m_coord, 4, GL_FLOAT, GL_FALSE, 0, 0);
+void DrawUtils::applySpriteState(const Sprite& sprite, 
+                                 SpriteProgram* program)
+{
+    GLState* gl_state = GLState::getGLState();
+    gl_state->useProgram(program->getProgram());
+    gl_state->setBlend(sprite.blend);
+    gl_state->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state->activeTexture(GL_TEXTURE0);
+    gl_state->bindTexture(sprite.texture->id);
+}
 
-    glUniform1i(m_draw_texture->m_tex, 0);
+void DrawUtils::drawSpriteRange(const Sprite& sprite, int first, int count)
+{
+    SpriteProgram* program = getSpriteProgram(sprite);
+    
+    if (program == NULL)
+        return;
+    
+    applySpriteState(sprite, program);
+    
+    glDrawElements(GL_TRIANGLES, count * 6, GL_UNSIGNED_SHORT, 
+                   (void*)(first * 6 * sizeof(GLushort)));
+    Telemetry::getTelemetry()->addDrawCall();
+}
 
-    glActiveTexture(GL_TEXTURE0);
+void DrawUtils::submit(Texture* texture, SpriteType type, int pos_x, 
+                       int pos_y, int width, int height, 
+                       const float tex_coords[4], const GLfloat color[4])
+{
+    Sprite sprite;
+    makeSprite(texture, type, pos_x, pos_y, width, height, tex_coords, color,
+               sprite);
+    
+    m_sprites.push_back(sprite);
+}
+
+SpriteProgram* DrawUtils::getSpriteProgram(const Sprite& sprite)
+{
+    return m_sprite_programs.get(sprite.features);
+}
+
+void DrawUtils::flush()
+{
+    if (m_sprites.empty())
+        return;
+    
+    GLState* gl_state = GLState::getGLState();
+    
+    if (m_instanced)
+    {
+        gl_state->bindVertexArray(m_instanced_vao);
+        gl_state->bindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+    }
+    else
+    {
+        gl_state->bindVertexArray(0);
+        gl_state->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        gl_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    }
+    
+    int sprites_count = m_sprites.size();
+    
+    for (int first = 0; first < sprites_count; first += m_ring_size)
+    {
+        int count = std::min(sprites_count - first, m_ring_size);
+        
+        if (m_instanced)
+        {
+            drawSpritesInstanced(first, count);
+        }
+        else
+        {
+            drawSprites(first, count);
+        }
+    }
+    
+    gl_state->bindVertexArray(0);
+    
+    m_sprites.clear();
+}
+
+void DrawUtils::drawSprites(int first, int count)
+{
+    // The buffer is orphaned when it's full, so that the driver doesn't
+    // need to wait for draw calls that still use the old contents
+    if (m_ring_pos + count > m_ring_size)
+    {
+        glBufferData(GL_ARRAY_BUFFER, m_ring_size * 4 * sizeof(SpriteVertex), 
+                     NULL, GL_STREAM_DRAW);
+        m_ring_pos = 0;
+    }
+    
+    m_vertices.resize(count * 4);
+    
+    for (int i = 0; i < count; i++)
+    {
+        getSpriteVertices(m_sprites[first + i], &m_vertices[i * 4]);
+    }
+    
+    GLintptr offset = m_ring_pos * 4 * sizeof(SpriteVertex);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, 
+                    m_vertices.size() * sizeof(SpriteVertex), &m_vertices[0]);
+    Telemetry::getTelemetry()->addUploadBytes(m_vertices.size() * 
+                                              sizeof(SpriteVertex));
+    
+    setSpriteAttribs(offset);
+    
+    int run_start = 0;
+    
+    for (int i = 0; i < count; i++)
+    {
+        const Sprite& sprite = m_sprites[first + i];
+        
+        if (i + 1 < count)
+        {
+            const Sprite& next = m_sprites[first + i + 1];
+            
+            if (next.features == sprite.features && 
+                next.blend == sprite.blend &&
+                next.texture->id == sprite.texture->id)
+                continue;
+        }
+        
+        drawSpriteRange(sprite, run_start, i + 1 - run_start);
+        run_start = i + 1;
+    }
+    
+    m_ring_pos += count;
+}
 
-    if (texture->channels != 3)
+void DrawUtils::drawSpritesInstanced(int first, int count)
+{
+    if (m_ring_pos + count > m_ring_size)
     {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBufferData(GL_ARRAY_BUFFER, m_ring_size * sizeof(SpriteInstance), 
+                     NULL, GL_STREAM_DRAW);
+        m_ring_pos = 0;
     }
     
+    m_instances.resize(count);
+    
+    for (int i = 0; i < count; i++)
+    {
+        const Sprite& sprite = m_sprites[first + i];
+        SpriteInstance& instance = m_instances[i];
+        
+        // The unit quad is stretched from the top left corner down, which
+        // is up in the clip space
+        instance.rect[0] = sprite.rect[0];
+        instance.rect[1] = -sprite.rect[1];
+        instance.rect[2] = sprite.rect[2];
+        instance.rect[3] = -sprite.rect[3];
+        memcpy(instance.tex_coords, sprite.tex_coords, 
+               sizeof(instance.tex_coords));
+        memcpy(instance.color, sprite.color, sizeof(instance.color));
+    }
+    
+    GLintptr offset = m_ring_pos * sizeof(SpriteInstance);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, 
+                    m_instances.size() * sizeof(SpriteInstance), 
+                    &m_instances[0]);
+    Telemetry::getTelemetry()->addUploadBytes(m_instances.size() * 
+                                              sizeof(SpriteInstance));
+    
+    int run_start = 0;
+    
+    for (int i = 0; i < count; i++)
+    {
+        const Sprite& sprite = m_sprites[first + i];
+        
+        if (i + 1 < count)
+        {
+            const Sprite& next = m_sprites[first + i + 1];
+            
+            if (next.features == sprite.features && 
+                next.blend == sprite.blend &&
+                next.texture->id == sprite.texture->id)
+                continue;
+        }
+        
+        SpriteProgram* program = 
+                            m_sprite_instanced_programs.get(sprite.features);
+        
+        if (program != NULL)
+        {
+            // There is no base instance in GLES3, so the attrib pointers 
+            // are moved to the first instance of the run
+            setInstanceAttribs(offset + run_start * sizeof(SpriteInstance));
+            applySpriteState(sprite, program);
+            
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 
+                                  i + 1 - run_start);
+            Telemetry::getTelemetry()->addDrawCall();
+        }
+        
+        run_start = i + 1;
+    }
+    
+    m_ring_pos += count;
+}
+
+void DrawUtils::drawText(Texture* texture, int pos_x, int pos_y, int width,
+                         int height, const float tex_coords[4], 
+                         GLfloat color[4])
+{
+    submit(texture, SPRITE_GLYPH, pos_x, pos_y, width, height, tex_coords, 
+           color);
+}
+
+void DrawUtils::drawTextBuffer(GLuint vbo, Texture* texture, int first, 
+                               int count, int pos_x, int pos_y, 
+                               GLfloat color[4])
+{
+    // Retained meshes are drawn on top of sprites submitted so far
+    flush();
+    
+    GLState* gl_state = GLState::getGLState();
+    gl_state->bindVertexArray(0);
+    gl_state->useProgram(m_draw_text->getProgram());
+    gl_state->setAttribArrays(1 << m_draw_text->m_coord);
+    gl_state->bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(m_draw_text->m_coord, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    
     Device* device = DeviceManager::getDeviceManager()->getDevice();
     unsigned int window_w = device->getWindowWidth();
     unsigned int window_h = device->getWindowHeight();
 
     float x = (float)(pos_x) / window_w * 2.0f - 1.0f;
     float y = (float)(pos_y) / window_h * 2.0f - 1.0f;
-    float w = (float)(width) / window_w * 2.0f;
-    float h = (float)(height) / window_h * 2.0f;
-    float tex_w = texture->tex_w;
-    float tex_h = texture->tex_h;
-    
-    GLfloat box[4][4] = { {x, -y,         0, 0},
-                          {x + w, -y,     tex_w, 0},
-                          {x, -y - h,     0, tex_h},
-                          {x + w, -y - h, tex_w, tex_h} };
 
-    glBindTexture(GL_TEXTURE_2D, texture->id);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(box), box, GL_DYNAMIC_DRAW);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_draw_text->m_color.set(color);
+    m_draw_text->m_tex.set(0);
+    m_draw_text->m_offset.set(x, -y);
 
-    if (texture->channels != 3)
-    {
-        glDisable(GL_BLEND);
-    }
+    gl_state->setBlend(true);
+    gl_state->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state->activeTexture(GL_TEXTURE0);
+    gl_state->bindTexture(texture->id);
+    
+    glDrawArrays(GL_TRIANGLES, first, count);
+    Telemetry::getTelemetry()->addDrawCall();
+}
+
+void DrawUtils::drawTexture2D(Texture* texture, int pos_x, int pos_y, 
+                              int width, int height)
+{
+    float tex_coords[4] = {0.0f, 0.0f, texture->tex_w, texture->tex_h};
+    GLfloat color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
     
-    glDisableVertexAttribArray(m_draw_texture->m_coord);
-    glUseProgram(0);
+    submit(texture, SPRITE_TEXTURE, pos_x, pos_y, width, height, tex_coords,
+           color);
 }
@@ -20,39 +20,134 @@
 #include "shader.hpp"
 #include "texture_manager.hpp"
 
+#include <vector>
+
 class DrawTextProgram : public Shader
 {
 public:
     GLint m_coord;
-    GLint m_tex;
-    GLint m_color;
+    UniformInt m_tex;
+    UniformVec4 m_color;
+    UniformVec2 m_offset;
 
     bool create();
 };
 
-class DrawTextureProgram : public Shader
+// Compiled with SF_COVERAGE for glyphs, which use only the red channel of
+// the texture, with SF_TINT when the vertex color is not white, and with
+// SF_ALPHA_TEST for textures that are drawn without blending
+class SpriteProgram : public Shader
 {
 public:
-    GLint m_coord;
-    GLint m_tex;
+    UniformInt m_tex;
 
     bool create();
 };
 
+class SpriteInstancedProgram : public SpriteProgram
+{
+public:
+    bool create();
+};
+
+// Fixed attrib locations of the sprite programs
+enum SpriteAttrib
+{
+    SA_COORD = 0,
+    SA_COLOR = 1
+};
+
+enum InstanceAttrib
+{
+    IA_CORNER = 0,
+    IA_RECT = 1,
+    IA_UV = 2,
+    IA_COLOR = 3
+};
+
+enum SpriteType
+{
+    SPRITE_TEXTURE,
+    SPRITE_GLYPH
+};
+
+struct Sprite
+{
+    Texture* texture;
+    unsigned int features;
+    bool blend;
+    float rect[4];
+    float tex_coords[4];
+    GLubyte color[4];
+};
+
+struct SpriteVertex
+{
+    GLfloat coord[4];
+    GLubyte color[4];
+};
+
+struct SpriteInstance
+{
+    GLfloat rect[4];
+    GLfloat tex_coords[4];
+    GLubyte color[4];
+};
+
+// Quads are collected between begin() and flush() and drawn from a ring
+// vertex buffer. Sprites are drawn in the order in which they were submitted,
+// so that overlapping quads are painted correctly, and each run of adjacent
+// sprites with equal program, texture and blend state is a single draw call.
+// On GLES3 every quad is a single instance of a unit quad, otherwise four
+// vertices are generated for each quad.
 class DrawUtils
 {
 private:
     GLuint m_vbo;
+    GLuint m_ibo;
+    GLuint m_quad_vbo;
+    GLuint m_instance_vbo;
+    GLuint m_instanced_vao;
+    bool m_instanced;
+    int m_ring_size;
+    int m_ring_pos;
+    std::vector<Sprite> m_sprites;
+    std::vector<SpriteVertex> m_vertices;
+    std::vector<SpriteInstance> m_instances;
     DrawTextProgram* m_draw_text;
-    DrawTextureProgram* m_draw_texture;
+    ShaderVariants<SpriteProgram> m_sprite_programs;
+    ShaderVariants<SpriteInstancedProgram> m_sprite_instanced_programs;
     static DrawUtils* m_draw_utils;
+    
+    bool initInstancing();
+    void drawSprites(int first, int count);
+    void drawSpritesInstanced(int first, int count);
+    void setInstanceAttribs(GLintptr offset);
+    void applySpriteState(const Sprite& sprite, SpriteProgram* program);
 
 public:
     DrawUtils();
     ~DrawUtils();
     
     bool init();
-    void drawText(Texture* texture, int pos_x, int pos_y, GLfloat color[4]);
+    void begin();
+    void submit(Texture* texture, SpriteType type, int pos_x, int pos_y, 
+                int width, int height, const float tex_coords[4], 
+                const GLfloat color[4]);
+    void flush();
+    void makeSprite(Texture* texture, SpriteType type, int pos_x, int pos_y,
+                    int width, int height, const float tex_coords[4], 
+                    const GLfloat color[4], Sprite& sprite);
+    void getSpriteVertices(const Sprite& sprite, SpriteVertex vertices[4]);
+    void setSpriteAttribs(GLintptr offset);
+    void drawSpriteRange(const Sprite& sprite, int first, int count);
+    SpriteProgram* getSpriteProgram(const Sprite& sprite);
+    GLuint getQuadIndexBuffer() {return m_ibo;}
+    int getMaxQuadsCount() {return m_ring_size;}
+    void drawText(Texture* texture, int pos_x, int pos_y, int width, 
+                  int height, const float tex_coords[4], GLfloat color[4]);
+    void drawTextBuffer(GLuint vbo, Texture* texture, int first, int count,
+                        int pos_x, int pos_y, GLfloat color[4]);
     void drawTexture2D(Texture* texture, int pos_x, int pos_y, int width, 
                        int height);
     
@@ -226,11 +226,22 @@ struct GyroscopeEvent
     double z;
 };
 
+enum JoystickEventType
+{
+    JE_BUTTON,
+    JE_AXIS,
+    JE_CONNECTED,
+    JE_DISCONNECTED
+};
+
+// Only the button or axis that has changed is sent. Whole state of the
+// joystick is available in JoystickInfo.
 struct JoystickEvent
 {
+    JoystickEventType type;
     unsigned int id;
-    bool button_states[32];
-    int axis[32];
+    unsigned int number;
+    int value;
 };
 
 struct SystemEvent
@@ -16,6 +16,7 @@
 
 #include "file_manager.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include <fstream>
@@ -23,6 +24,9 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 #ifdef ANDROID
@@ -32,8 +36,18 @@
 extern struct android_app* g_android_app;
 #endif
 
+#ifndef PROJECT_NAME
+#define PROJECT_NAME "SimpleWindow"
+#endif
+
 const std::string data_dir = "data/";
 
+// Files that are generated by the build, such as the font atlas, are kept in
+// the build directory
+#ifdef GENERATED_DATA_DIR
+const std::string generated_data_dir = GENERATED_DATA_DIR;
+#endif
+
 FileManager* FileManager::m_file_manager = NULL;
 
 FileManager::FileManager()
@@ -81,12 +95,37 @@ bool FileManager::createAssetsList()
     closeFile(file);
 #else
 
-    getFileList(data_dir, m_assets_list);
+    getFileList(data_dir, data_dir, m_assets_list);
+    
+#ifdef GENERATED_DATA_DIR
+    getFileList(generated_data_dir, generated_data_dir, m_assets_list);
+    
+    // Files may be in both directories if an older build left them in the
+    // source tree
+    std::sort(m_assets_list.begin(), m_assets_list.end());
+    m_assets_list.erase(std::unique(m_assets_list.begin(), 
+                                    m_assets_list.end()),
+                        m_assets_list.end());
+#endif
 #endif
     
     return true;
 }
 
+// Generated files take precedence, because copies that were left in the
+// source tree by older builds may be outdated
+std::string FileManager::getFilePath(std::string filename)
+{
+#ifdef GENERATED_DATA_DIR
+    std::string generated_path = generated_data_dir + filename;
+    
+    if (fileExists(generated_path))
+        return generated_path;
+#endif
+
+    return data_dir + filename;
+}
+
 File* FileManager::loadFile(std::string filename)
 {
     std::string file_path = data_dir + filename;
@@ -96,6 +135,8 @@ File* FileManager::loadFile(std::string filename)
     if (file != NULL)
         return file;
     
+    file_path = getFilePath(filename);
+    
     std::ifstream is;
     is.open(file_path.c_str(), std::ios::binary);
     
@@ -176,17 +217,120 @@ File* FileManager::loadFileFromAssets(std::string file_path)
 #endif
 }
 
+File* FileManager::mapFile(std::string filename)
+{
+    std::string file_path = data_dir + filename;
+    
+    File* file = mapFileFromAssets(file_path);
+    
+    if (file != NULL)
+        return file;
+    
+    file_path = getFilePath(filename);
+    
+    int fd = open(file_path.c_str(), O_RDONLY);
+    
+    if (fd == -1)
+    {
+        printf("Error: Could not open file %s\n", file_path.c_str());
+        return NULL;
+    }
+    
+    struct stat stat_info;
+    
+    if (fstat(fd, &stat_info) != 0 || stat_info.st_size <= 0)
+    {
+        printf("Error: Could not open file %s\n", file_path.c_str());
+        close(fd);
+        return NULL;
+    }
+    
+    void* data = mmap(NULL, stat_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    
+    if (data == MAP_FAILED)
+    {
+        // Fall back to reading the whole file if it can't be mapped
+        return loadFile(filename);
+    }
+    
+    file = new File();
+    file->data = (char*)data;
+    file->length = stat_info.st_size;
+    file->storage = FS_MAPPED;
+    
+    return file;
+}
+
+File* FileManager::mapFileFromAssets(std::string file_path)
+{
+#ifdef ANDROID
+    if (g_android_app == NULL)
+        return NULL;
+    
+    AAssetManager* asset_manager = g_android_app->activity->assetManager;
+    
+    if (asset_manager == NULL)
+        return NULL;
+    
+    // Uncompressed assets are mapped directly from the apk, so the buffer
+    // can be used without copying it
+    AAsset* asset = AAssetManager_open(asset_manager, file_path.c_str(),
+                                       AASSET_MODE_BUFFER);
+
+    if (asset == NULL)
+    {
+        printf("Error: Could not open asset %s", file_path.c_str());
+        return NULL;
+    }
+    
+    const void* buffer = AAsset_getBuffer(asset);
+    
+    if (buffer == NULL)
+    {
+        printf("Error: Could not open asset %s", file_path.c_str());
+        AAsset_close(asset);
+        return NULL;
+    }
+    
+    File* file = new File();
+    file->data = (char*)buffer;
+    file->length = AAsset_getLength(asset);
+    file->storage = FS_ASSET;
+    file->handle = asset;
+    
+    return file;
+    
+#else
+    return NULL;
+#endif
+}
+
 void FileManager::closeFile(File* file)
 {
     if (file == NULL)
         return;
 
-    delete[] file->data;
+    switch (file->storage)
+    {
+    case FS_BUFFER:
+        delete[] file->data;
+        break;
+    case FS_MAPPED:
+        munmap(file->data, file->length);
+        break;
+    case FS_ASSET:
+#ifdef ANDROID
+        AAsset_close((AAsset*)file->handle);
+#endif
+        break;
+    }
+    
     delete file;
 }
 
 
-void FileManager::getFileList(std::string dir_name, 
+void FileManager::getFileList(std::string base_dir, std::string dir_name, 
                               std::vector<std::string>& file_list)
 {
     DIR* dir = opendir(dir_name.c_str());
@@ -213,11 +357,11 @@ void FileManager::getFileList(std::string dir_name,
         
         if (is_directory)
         {
-            getFileList(file_path + "/", file_list);
+            getFileList(base_dir, file_path + "/", file_list);
         }
         else
         {
-            std::string asset_path = file_path.substr(data_dir.size());
+            std::string asset_path = file_path.substr(base_dir.size());
             file_list.push_back(asset_path);
         }
     } 
@@ -363,6 +507,43 @@ bool FileManager::touchFile(std::string path)
     return success;
 }
 
+// Writable directory for the files that can be recreated at any time. It's
+// created if it doesn't exist, and empty string is returned on failure.
+std::string FileManager::getCacheDir()
+{
+    std::string cache_dir;
+    
+#ifdef ANDROID
+    if (g_android_app->activity->internalDataPath)
+    {
+        cache_dir = std::string(g_android_app->activity->internalDataPath) + 
+                    "/cache";
+    }
+#else
+    if (getenv("XDG_CACHE_HOME"))
+    {
+        cache_dir = std::string(getenv("XDG_CACHE_HOME")) + "/" + 
+                    PROJECT_NAME;
+    }
+    else if (getenv("HOME"))
+    {
+        cache_dir = std::string(getenv("HOME")) + "/.cache/" + PROJECT_NAME;
+    }
+#endif
+
+    if (cache_dir.empty())
+        return "";
+        
+    if (!createDirectoryRecursive(cache_dir))
+    {
+        printf("Warning: Couldn't create cache directory %s\n", 
+               cache_dir.c_str());
+        return "";
+    }
+    
+    return cache_dir;
+}
+
 std::string FileManager::findExternalDataDir(std::string dir_name, 
                                              std::string alternative_dir_name,
                                              std::string project_name, 
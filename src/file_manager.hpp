@@ -20,10 +20,19 @@
 #include <string>
 #include <vector>
 
+enum FileStorage
+{
+    FS_BUFFER,
+    FS_MAPPED,
+    FS_ASSET
+};
+
 struct File
 {
     int length;
     char* data;
+    FileStorage storage;
+    void* handle;
 };
 
 class FileManager
@@ -34,7 +43,10 @@ private:
     
     bool createAssetsList();
     File* loadFileFromAssets(std::string file_path);
-    void getFileList(std::string dir_name, std::vector<std::string>& file_list);
+    File* mapFileFromAssets(std::string file_path);
+    void getFileList(std::string base_dir, std::string dir_name, 
+                     std::vector<std::string>& file_list);
+    std::string getFilePath(std::string filename);
     
 public:
     FileManager();
@@ -42,6 +54,7 @@ public:
 
     bool init();
     File* loadFile(std::string filename);
+    File* mapFile(std::string filename);
     void closeFile(File* file);
     bool extractFromAssets(std::string filename, std::string base_dir, 
                            std::string dest_dir);
@@ -53,6 +66,7 @@ public:
     bool createDirectory(std::string path);
     bool createDirectoryRecursive(std::string path);
     bool touchFile(std::string path);
+    std::string getCacheDir();
     
     std::string findExternalDataDir(std::string dir_name, 
                                     std::string alternative_dir_name,
@@ -0,0 +1,118 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FONT_ATLAS_HPP
+#define FONT_ATLAS_HPP
+
+#include <stdint.h>
+
+// Layout of the prebaked font atlas metrics file generated by font_baker.
+// The file contains a header, then fonts_count font entries and then
+// glyphs_count glyph entries. The atlas itself is stored in a separate
+// 8-bit grayscale png file.
+
+#define FONT_ATLAS_MAGIC "STKF"
+#define FONT_ATLAS_VERSION 1
+#define FONT_ATLAS_NAME_LENGTH 64
+#define FONT_ATLAS_PADDING 1
+
+struct FontAtlasHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t used_height;
+    uint32_t fonts_count;
+    uint32_t glyphs_count;
+};
+
+struct FontAtlasFont
+{
+    char name[FONT_ATLAS_NAME_LENGTH];
+};
+
+struct FontAtlasGlyph
+{
+    uint32_t font_id;
+    uint32_t size;
+    uint32_t codepoint;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    int16_t left;
+    int16_t top;
+    int16_t advance;
+    int16_t reserved;
+};
+
+// Simple shelf packer that is shared between the atlas generator and the
+// runtime glyph cache, so that glyphs rendered at runtime can be placed in
+// the free space below the prebaked glyphs.
+class ShelfPacker
+{
+private:
+    int m_width;
+    int m_height;
+    int m_pos_x;
+    int m_pos_y;
+    int m_shelf_height;
+
+public:
+    ShelfPacker() : m_width(0), m_height(0), m_pos_x(0), m_pos_y(0),
+                    m_shelf_height(0) {}
+
+    void init(int width, int height, int start_y = 0)
+    {
+        m_width = width;
+        m_height = height;
+        m_pos_x = 0;
+        m_pos_y = start_y;
+        m_shelf_height = 0;
+    }
+
+    bool pack(int width, int height, int* pos_x, int* pos_y)
+    {
+        int w = width + FONT_ATLAS_PADDING;
+        int h = height + FONT_ATLAS_PADDING;
+
+        if (w > m_width)
+            return false;
+
+        if (m_pos_x + w > m_width)
+        {
+            m_pos_x = 0;
+            m_pos_y += m_shelf_height;
+            m_shelf_height = 0;
+        }
+
+        if (m_pos_y + h > m_height)
+            return false;
+
+        *pos_x = m_pos_x;
+        *pos_y = m_pos_y;
+
+        m_pos_x += w;
+        m_shelf_height = m_shelf_height > h ? m_shelf_height : h;
+
+        return true;
+    }
+
+    int getUsedHeight() {return m_pos_y + m_shelf_height;}
+};
+
+#endif
@@ -14,227 +14,521 @@
 //    You should have received a copy of the GNU General Public License
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include "device_manager.hpp"
 #include "draw_utils.hpp"
 #include "font_manager.hpp"
+#include "job_queue.hpp"
+#include "utf8.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 
 FontManager* FontManager::m_font_manager = NULL;
 
 FontManager::FontManager()
 {
+    m_ft_library = NULL;
+    m_ft_initialized = false;
     m_current_font = NULL;
+    m_glyph_atlas = NULL;
+    m_glyph_rasterizer = NULL;
+    m_atlas_generation = 0;
+    m_upload_job_queued = false;
     m_font_manager = this;
 }
 
 bool FontManager::init()
 {
-    int err = FT_Init_FreeType(&m_ft_library);
-    
-    if (err != 0) 
-    {
-        printf("Error: Could not initialize freetype library\n");
-        return false;
-    }
+    m_glyph_atlas = new GlyphAtlas();
     
     FileManager* file_manager = FileManager::getFileManager();
     std::vector<std::string> assets_list = file_manager->getAssetsList();
     
+    // Fonts are only registered here. Only the fonts from the main data
+    // directory are used by the UI, so fonts from the add-ons that are
+    // extracted by the installer are never loaded. The font file and the
+    // freetype face are opened on first use.
     for (std::string font_name : assets_list)
     {
+        if (font_name.find("/") != std::string::npos)
+            continue;
+        
         std::string extension = file_manager->getExtension(font_name);
         
         if (extension != ".ttf" && extension != ".otf")
             continue;
-
-        File* file = file_manager->loadFile(font_name);
-        
-        if (file == NULL)
-            continue;
         
         FontData* font = new FontData();
         font->font_name = font_name;
-        font->font_file = file;
-        
-        int err = FT_New_Memory_Face(m_ft_library, (FT_Byte*)file->data, 
-                                     file->length, 0, &font->ft_face);
-        
-        if (err != 0) 
-        {
-            printf("Error: Could not create font face for %s\n", 
-                   font_name.c_str());
-            file_manager->closeFile(file);
-            delete font;
-            continue;
-        }
-    
-        FT_Select_Charmap(font->ft_face, ft_encoding_unicode);
+        font->font_file = NULL;
+        font->ft_face = NULL;
+        font->ft_size = 0;
+        font->prebaked = false;
         
         m_fonts.push_back(font);
     }
+    
+    loadPrebakedFonts();
+    
+    // Glyphs that are not in the prebaked atlas are rendered in background,
+    // so that a lot of new characters at once doesn't stall the frame. The
+    // worker threads are started when the first such glyph is requested.
+    unsigned int threads_count = std::thread::hardware_concurrency();
+    threads_count = std::max(std::min(threads_count, 5u), 2u) - 1;
+    
+    m_glyph_rasterizer = new GlyphRasterizer();
+    
+    if (!m_glyph_rasterizer->init(threads_count))
+    {
+        delete m_glyph_rasterizer;
+        m_glyph_rasterizer = NULL;
+    }
 
     return true;
 }
 
 FontManager::~FontManager()
 {
+    // Workers use the font files, so they must be stopped first
+    delete m_glyph_rasterizer;
+    
     FileManager* file_manager = FileManager::getFileManager();
-    TextureManager* texture_manager = TextureManager::getTextureManager();
 
     for (FontData* font : m_fonts)
     {
-        for (auto texture : font->chars)
+        if (font->ft_face != NULL)
         {
-            texture_manager->deleteTexture(texture.second);
+            FT_Done_Face(font->ft_face);
         }
         
-        FT_Done_Face(font->ft_face);
-        
         file_manager->closeFile(font->font_file);
         delete font;
     }
     
-    FT_Done_FreeType(m_ft_library);
+    delete m_glyph_atlas;
+    
+    if (m_ft_initialized)
+    {
+        FT_Done_FreeType(m_ft_library);
+    }
 }
 
-void FontManager::changeFont(std::string font_name)
+FontData* FontManager::findFont(std::string font_name)
 {
     for (FontData* font : m_fonts)
     {
         if (font->font_name == font_name)
-        {
-            m_current_font = font;
-            return;
-        }
+            return font;
     }
     
-    m_current_font = NULL;
+    return NULL;
 }
 
-std::wstring FontManager::convertToUTF32(std::string str)
+bool FontManager::loadPrebakedFonts()
 {
-    // std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> cvt;
-    // std::u32string str32 = cvt.from_bytes(str);
+    FileManager* file_manager = FileManager::getFileManager();
+    TextureManager* texture_manager = TextureManager::getTextureManager();
     
-    std::wstring result;
-    unsigned int codepoint;
-
-    for (unsigned int i = 0; i < str.length(); i++)
+    std::vector<std::string>& assets_list = file_manager->getAssetsList();
+    
+    if (std::find(assets_list.begin(), assets_list.end(), "font_atlas.bin") == 
+                                                              assets_list.end())
+        return false;
+    
+    Texture* texture = texture_manager->getTexture("font_atlas.png");
+    
+    if (texture == NULL || texture->channels != 1)
+        return false;
+    
+    File* file = file_manager->loadFile("font_atlas.bin");
+    
+    if (file == NULL)
+        return false;
+    
+    FontAtlasHeader header;
+    
+    if (file->length < (int)sizeof(header))
     {
-        unsigned char ch = (unsigned char)(str.at(i));
+        printf("Error: Invalid font atlas file\n");
+        file_manager->closeFile(file);
+        return false;
+    }
+    
+    memcpy(&header, file->data, sizeof(header));
+    
+    unsigned int expected_length = sizeof(header) + 
+                            header.fonts_count * sizeof(FontAtlasFont) +
+                            header.glyphs_count * sizeof(FontAtlasGlyph);
+    
+    if (memcmp(header.magic, FONT_ATLAS_MAGIC, 4) != 0 ||
+        header.version != FONT_ATLAS_VERSION ||
+        (int)header.width != texture->width ||
+        (int)header.height != texture->height ||
+        (unsigned int)file->length != expected_length)
+    {
+        printf("Error: Font atlas doesn't match its texture\n");
+        file_manager->closeFile(file);
+        return false;
+    }
+    
+    const char* data = file->data + sizeof(header);
+    std::vector<FontData*> fonts;
+    
+    for (unsigned int i = 0; i < header.fonts_count; i++)
+    {
+        FontAtlasFont font_info;
+        memcpy(&font_info, data, sizeof(font_info));
+        data += sizeof(font_info);
         
-        if (ch <= 0x7f)
-        {
-            codepoint = ch;
-        }
-        else if (ch <= 0xbf)
+        font_info.name[FONT_ATLAS_NAME_LENGTH - 1] = 0;
+        fonts.push_back(findFont(font_info.name));
+    }
+    
+    for (unsigned int i = 0; i < header.glyphs_count; i++)
+    {
+        FontAtlasGlyph glyph_info;
+        memcpy(&glyph_info, data, sizeof(glyph_info));
+        data += sizeof(glyph_info);
+        
+        if (glyph_info.font_id >= fonts.size() || 
+            fonts[glyph_info.font_id] == NULL)
+            continue;
+        
+        Glyph glyph;
+        glyph.width = glyph_info.width;
+        glyph.height = glyph_info.height;
+        glyph.left = glyph_info.left;
+        glyph.top = glyph_info.top;
+        glyph.advance = glyph_info.advance;
+        glyph.texture = NULL;
+        
+        if (glyph.width > 0 && glyph.height > 0)
         {
-            codepoint = (codepoint << 6) | (ch & 0x3f);
+            m_glyph_atlas->setGlyphRegion(texture, glyph_info.x, glyph_info.y,
+                                          glyph);
         }
-        else if (ch <= 0xdf)
+        
+        uint64_t key = getGlyphKey(glyph_info.codepoint, glyph_info.size);
+        fonts[glyph_info.font_id]->glyphs[key] = glyph;
+        fonts[glyph_info.font_id]->prebaked = true;
+    }
+    
+    m_glyph_atlas->addPage(texture, header.used_height, false);
+    
+    file_manager->closeFile(file);
+    
+    return true;
+}
+
+bool FontManager::loadFace(FontData* font)
+{
+    if (font->ft_face != NULL)
+        return true;
+    
+    if (!m_ft_initialized)
+    {
+        int err = FT_Init_FreeType(&m_ft_library);
+        
+        if (err != 0) 
         {
-            codepoint = ch & 0x1f;
+            printf("Error: Could not initialize freetype library\n");
+            return false;
         }
-        else if (ch <= 0xef)
+        
+        m_ft_initialized = true;
+    }
+    
+    FileManager* file_manager = FileManager::getFileManager();
+    
+    if (font->font_file == NULL)
+    {
+        font->font_file = file_manager->mapFile(font->font_name);
+        
+        if (font->font_file == NULL)
+            return false;
+    }
+    
+    int err = FT_New_Memory_Face(m_ft_library, (FT_Byte*)font->font_file->data, 
+                                 font->font_file->length, 0, &font->ft_face);
+    
+    if (err != 0) 
+    {
+        printf("Error: Could not create font face for %s\n", 
+               font->font_name.c_str());
+        font->ft_face = NULL;
+        file_manager->closeFile(font->font_file);
+        font->font_file = NULL;
+        return false;
+    }
+
+    FT_Select_Charmap(font->ft_face, ft_encoding_unicode);
+    
+    return true;
+}
+
+void FontManager::changeFont(std::string font_name)
+{
+    m_current_font = findFont(font_name);
+    
+    // Fonts that are covered by the prebaked atlas are opened only when
+    // some glyph is missing
+    if (m_current_font != NULL && !m_current_font->prebaked)
+    {
+        loadFace(m_current_font);
+    }
+}
+
+Glyph* FontManager::getGlyph(unsigned int codepoint, int size, bool wait)
+{
+    uint64_t key = getGlyphKey(codepoint, size);
+    auto it = m_current_font->glyphs.find(key);
+    
+    if (it != m_current_font->glyphs.end())
+    {
+        if (!wait || m_current_font->pending_glyphs.count(key) == 0)
+            return &it->second;
+    }
+    else if (!wait && m_glyph_rasterizer != NULL)
+    {
+        return requestGlyph(codepoint, size);
+    }
+    
+    m_current_font->pending_glyphs.erase(key);
+    return renderGlyph(codepoint, size);
+}
+
+Glyph* FontManager::requestGlyph(unsigned int codepoint, int size)
+{
+    if (!loadFace(m_current_font))
+        return renderGlyph(codepoint, size);
+    
+    bool requested = m_glyph_rasterizer->requestGlyph(m_current_font, 
+                                                      m_current_font->font_file,
+                                                      codepoint, size);
+    
+    // Glyphs are rendered synchronously if the workers couldn't be started
+    if (!requested)
+    {
+        delete m_glyph_rasterizer;
+        m_glyph_rasterizer = NULL;
+        return renderGlyph(codepoint, size);
+    }
+    
+    // Empty placeholder is used until the glyph is rendered. Its advance is
+    // already the real one, so that text that is measured in the meantime
+    // doesn't have to be laid out again.
+    Glyph glyph;
+    memset(&glyph, 0, sizeof(glyph));
+    glyph.advance = getGlyphAdvance(codepoint, size);
+    
+    uint64_t key = getGlyphKey(codepoint, size);
+    m_current_font->pending_glyphs.insert(key);
+    Glyph& result = m_current_font->glyphs[key];
+    result = glyph;
+    
+    return &result;
+}
+
+// Glyphs that were rendered in background are copied to the atlas in a job,
+// so that a lot of new text doesn't stall a single frame
+void FontManager::update()
+{
+    if (m_glyph_rasterizer == NULL)
+        return;
+    
+    m_glyph_rasterizer->getResults(m_rasterized_glyphs);
+    
+    for (GlyphBitmap& bitmap : m_rasterized_glyphs)
+    {
+        m_glyph_uploads.push_back(GlyphBitmap());
+        std::swap(m_glyph_uploads.back(), bitmap);
+    }
+    
+    if (m_glyph_uploads.empty() || m_upload_job_queued)
+        return;
+    
+    JobQueue* job_queue = JobQueue::getJobQueue();
+    job_queue->addJob([this]() {return uploadGlyph();}, JP_HIGH, 
+                      GLYPH_UPLOAD_DEADLINE);
+    m_upload_job_queued = true;
+}
+
+bool FontManager::uploadGlyph()
+{
+    if (m_glyph_uploads.empty())
+    {
+        m_upload_job_queued = false;
+        return true;
+    }
+    
+    GlyphBitmap& bitmap = m_glyph_uploads.front();
+    uint64_t key = getGlyphKey(bitmap.codepoint, bitmap.size);
+    
+    // The glyph may have been rendered synchronously in the meantime
+    if (bitmap.font->pending_glyphs.erase(key) > 0)
+    {
+        // The placeholder advance is kept if the glyph can't be added, so
+        // that the text doesn't change its width
+        int advance = bitmap.font->glyphs[key].advance;
+        
+        Glyph glyph;
+        memset(&glyph, 0, sizeof(glyph));
+        glyph.advance = advance;
+        
+        if (bitmap.success)
         {
-            codepoint = ch & 0x0f;
+            bool success = m_glyph_atlas->addGlyph(bitmap.width, bitmap.height,
+                                                   bitmap.width, 
+                                                   bitmap.pixels.data(), glyph);
+            
+            if (success)
+            {
+                glyph.left = bitmap.left;
+                glyph.top = bitmap.top;
+                glyph.advance = bitmap.advance;
+            }
+            else
+            {
+                memset(&glyph, 0, sizeof(glyph));
+                glyph.advance = advance;
+            }
         }
-        else
+        
+        bitmap.font->glyphs[key] = glyph;
+        
+        m_atlas_generation++;
+        
+        Device* device = DeviceManager::getDeviceManager()->getDevice();
+        device->requestRedraw();
+    }
+    
+    m_glyph_uploads.pop_front();
+    
+    if (!m_glyph_uploads.empty())
+        return false;
+    
+    m_upload_job_queued = false;
+    return true;
+}
+
+bool FontManager::hasPendingGlyphs()
+{
+    for (FontData* font : m_fonts)
+    {
+        if (!font->pending_glyphs.empty())
+            return true;
+    }
+    
+    return false;
+}
+
+// Reads only the metrics, which is much cheaper than rendering the glyph.
+// The value is the same as the advance of the rendered glyph.
+int FontManager::getGlyphAdvance(unsigned int codepoint, int size)
+{
+    FT_Face ft_face = m_current_font->ft_face;
+    
+    if (m_current_font->ft_size != size)
+    {
+        FT_Set_Pixel_Sizes(ft_face, 0, size);
+        m_current_font->ft_size = size;
+    }
+    
+    FT_UInt index = FT_Get_Char_Index(ft_face, codepoint);
+    FT_Fixed advance = 0;
+    
+    if (FT_Get_Advance(ft_face, index, FT_LOAD_DEFAULT, &advance) != 0)
+        return 0;
+    
+    // Scaled advance is in 16.16 fixed point
+    return advance >> 16;
+}
+
+Glyph* FontManager::renderGlyph(unsigned int codepoint, int size)
+{
+    Glyph glyph;
+    memset(&glyph, 0, sizeof(glyph));
+    
+    // Glyphs that failed are cached too, so that missing characters don't
+    // hit freetype on every frame
+    if (loadFace(m_current_font))
+    {
+        FT_Face ft_face = m_current_font->ft_face;
+        
+        if (m_current_font->ft_size != size)
         {
-            codepoint = ch & 0x07;
+            FT_Set_Pixel_Sizes(ft_face, 0, size);
+            m_current_font->ft_size = size;
         }
-
-        if ((i == str.length() - 1 || (str.at(i+1) & 0xc0) != 0x80) && 
-            (codepoint <= 0x10ffff))
+        
+        if (!FT_Load_Char(ft_face, codepoint, FT_LOAD_RENDER))
         {
-            if (sizeof(wchar_t) > 2)
-            {
-                result += (wchar_t)(codepoint);
-            }
-            else if (codepoint > 0xffff)
+            FT_GlyphSlot g = ft_face->glyph;
+            
+            bool success = m_glyph_atlas->addGlyph(g->bitmap.width, 
+                                                   g->bitmap.rows,
+                                                   g->bitmap.pitch,
+                                                   g->bitmap.buffer, glyph);
+            
+            if (success)
             {
-                result += (wchar_t)(0xd800 + (codepoint >> 10));
-                result += (wchar_t)(0xdc00 + (codepoint & 0x03ff));
+                glyph.left = g->bitmap_left;
+                glyph.top = g->bitmap_top;
+                glyph.advance = g->advance.x / 64;
             }
-            else if (codepoint < 0xd800 || codepoint >= 0xe000)
+            else
             {
-                result += (wchar_t)(codepoint);
+                memset(&glyph, 0, sizeof(glyph));
             }
         }
     }
     
-    return result;
+    uint64_t key = getGlyphKey(codepoint, size);
+    Glyph& result = m_current_font->glyphs[key];
+    result = glyph;
+    
+    return &result;
 }
 
 void FontManager::drawText(std::string text, int pos_x, int pos_y, int size, 
-                           float color[4])
-{
-    std::wstring text32 = convertToUTF32(text);
-    drawText(text32, pos_x, pos_y, size, color);
-}
-
-void FontManager::drawText(std::wstring text, int pos_x, int pos_y, int size, 
                            float color[4]) 
 {
     if (m_current_font == NULL)
         return;
        
     DrawUtils* draw_utils = DrawUtils::getDrawUtils();
-    TextureManager* texture_manager = TextureManager::getTextureManager();
     
-    FT_Set_Pixel_Sizes(m_current_font->ft_face, 0, size);
-    FT_GlyphSlot g = m_current_font->ft_face->glyph;
+    UTF8Iterator it(text);
+    uint32_t c;
     
-    for (wchar_t c : text) 
+    while (it.next(c)) 
     {
-        if (FT_Load_Char(m_current_font->ft_face, c, FT_LOAD_RENDER))
-            continue;
-                    
-        std::ostringstream code_ss;
-        code_ss << size;
-        code_ss << c;
-        std::string code = code_ss.str();
-        
-        Texture* texture = m_current_font->chars[code];
+        Glyph* glyph = getGlyph(c, size);
 
-        if (texture == NULL)
+        if (glyph->texture != NULL)
         {
-            texture = texture_manager->createTexture(g->bitmap.width, 
-                                                     g->bitmap.rows, 1,                                                   
-                                                     g->bitmap.buffer);
-            m_current_font->chars[code] = texture;
+            draw_utils->drawText(glyph->texture, pos_x + glyph->left, 
+                                 pos_y - glyph->top, glyph->width, 
+                                 glyph->height, glyph->tex_coords, color);
         }
 
-        draw_utils->drawText(texture, pos_x + g->bitmap_left, 
-                             pos_y - g->bitmap_top, color);
-
-        pos_x += (g->advance.x / 64);
-        pos_y += (g->advance.y / 64);
+        pos_x += glyph->advance;
     }
 }
 
-int FontManager::getTextWidth(std::string text, int size)
-{
-    std::wstring text32 = convertToUTF32(text);
-    return getTextWidth(text32, size);
-}
-
-int FontManager::getTextWidth(std::wstring text, int size) 
+int FontManager::getTextWidth(std::string text, int size) 
 {
     if (m_current_font == NULL)
         return 0;
-       
-    FT_Set_Pixel_Sizes(m_current_font->ft_face, 0, size);
-    FT_GlyphSlot g = m_current_font->ft_face->glyph;
     
     int width = 0;
     
-    for (wchar_t c : text) 
+    UTF8Iterator it(text);
+    uint32_t c;
+    
+    while (it.next(c)) 
     {
-        if (FT_Load_Char(m_current_font->ft_face, c, FT_LOAD_RENDER))
-            continue;
-
-        width += (g->advance.x / 64);
+        width += getGlyph(c, size)->advance;
     }
     
     return width;
@@ -245,10 +539,5 @@ int FontManager::getRealFontHeight(int size)
     if (m_current_font == NULL)
         return 0;
         
-    FT_Set_Pixel_Sizes(m_current_font->ft_face, 0, size);
-    
-    if (FT_Load_Char(m_current_font->ft_face, L'X', FT_LOAD_RENDER))
-        return 0;
-        
-    return (m_current_font->ft_face->glyph->bitmap.rows);
+    return getGlyph('X', size, true)->height;
 }
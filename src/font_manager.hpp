@@ -18,47 +18,75 @@
 #define FONT_MANAGER_HPP
 
 #include "file_manager.hpp"
+#include "glyph_atlas.hpp"
+#include "glyph_rasterizer.hpp"
 #include "texture_manager.hpp"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_ADVANCES_H
 
+#include <deque>
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 struct FontData
 {
     std::string font_name;
-    std::map<std::string, Texture*> chars;
+    std::unordered_map<uint64_t, Glyph> glyphs;
+    std::unordered_set<uint64_t> pending_glyphs;
     File* font_file;
     FT_Face ft_face;
+    int ft_size;
+    bool prebaked;
 };
 
+// Placeholders are shown at most for this time in milliseconds after the 
+// glyph has been rendered, otherwise it's counted as a missed deadline
+#define GLYPH_UPLOAD_DEADLINE 50
+
 class FontManager
 {
 private:
     FT_Library m_ft_library;
+    bool m_ft_initialized;
     std::vector<FontData*> m_fonts;
     FontData* m_current_font;
+    GlyphAtlas* m_glyph_atlas;
+    GlyphRasterizer* m_glyph_rasterizer;
+    unsigned int m_atlas_generation;
+    std::vector<GlyphBitmap> m_rasterized_glyphs;
+    std::deque<GlyphBitmap> m_glyph_uploads;
+    bool m_upload_job_queued;
     static FontManager* m_font_manager;
     
-    std::wstring convertToUTF32(std::string str);
+    FontData* findFont(std::string font_name);
+    bool loadPrebakedFonts();
+    bool loadFace(FontData* font);
+    int getGlyphAdvance(unsigned int codepoint, int size);
+    Glyph* renderGlyph(unsigned int codepoint, int size);
+    Glyph* requestGlyph(unsigned int codepoint, int size);
+    bool uploadGlyph();
+    
+    static uint64_t getGlyphKey(unsigned int codepoint, int size)
+                              {return ((uint64_t)size << 32) | codepoint;}
 
 public:
     FontManager();
     ~FontManager();
     
     bool init();
-    bool initFont(std::string font_name);
     void changeFont(std::string font_name);
+    void update();
+    bool hasPendingGlyphs();
+    Glyph* getGlyph(unsigned int codepoint, int size, bool wait = false);
     void drawText(std::string text, int pos_x, int pos_y, int size, 
                   GLfloat color[4]);
-    void drawText(std::wstring text, int pos_x, int pos_y, int size, 
-                  GLfloat color[4]);
     int getTextWidth(std::string text, int size);
-    int getTextWidth(std::wstring text, int size);
     int getRealFontHeight(int size);
+    unsigned int getAtlasGeneration() {return m_atlas_generation;}
     
     static FontManager* getFontManager() {return m_font_manager;}
 };
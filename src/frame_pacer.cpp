@@ -0,0 +1,177 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_manager.hpp"
+#include "frame_pacer.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+
+// Longer gaps between frames mean that the loop was waiting for events, so
+// they are not counted as frame times
+const long long FRAME_PACER_IDLE_NS = 100000000;
+
+FramePacer::FramePacer()
+{
+    m_frame_ns = 0;
+    m_deadline_ns = 0;
+    m_oversleep_ns = 0;
+    m_last_frame_ns = 0;
+
+    resetStats();
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+void FramePacer::init(unsigned int max_fps)
+{
+    m_frame_ns = max_fps > 0 ? 1000000000LL / max_fps : 0;
+    m_deadline_ns = 0;
+    m_oversleep_ns = 0;
+    m_last_frame_ns = 0;
+}
+
+long long FramePacer::getTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void FramePacer::sleepUntil(long long time_ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(time_ns / 1000000000LL);
+    ts.tv_nsec = (long)(time_ns % 1000000000LL);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+    }
+}
+
+bool FramePacer::isVSyncActive()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    ContextManagerEGL* egl_context = device->getEGLContext();
+
+    return egl_context != NULL && egl_context->getSwapInterval() > 0;
+}
+
+void FramePacer::wait()
+{
+    long long now = getTime();
+
+    if (m_frame_ns > 0 && !isVSyncActive())
+    {
+        if (now < m_deadline_ns)
+        {
+            long long wake_ns = m_deadline_ns - m_oversleep_ns;
+
+            if (wake_ns > now)
+            {
+                sleepUntil(wake_ns);
+                now = getTime();
+
+                // Moving average of how late the thread is woken up, limited
+                // so that a single hiccup can't make the pacer spin
+                long long oversleep = now - wake_ns;
+                m_oversleep_ns += (oversleep - m_oversleep_ns) / 8;
+
+                if (m_oversleep_ns < 0)
+                {
+                    m_oversleep_ns = 0;
+                }
+                else if (m_oversleep_ns > m_frame_ns / 4)
+                {
+                    m_oversleep_ns = m_frame_ns / 4;
+                }
+            }
+
+            m_deadline_ns += m_frame_ns;
+        }
+        else if (now - m_deadline_ns < m_frame_ns)
+        {
+            // Slightly late frame keeps the cadence
+            m_deadline_ns += m_frame_ns;
+        }
+        else
+        {
+            // Long frame or waiting for events, so the cadence starts again
+            m_deadline_ns = now + m_frame_ns;
+        }
+    }
+
+    if (m_last_frame_ns > 0)
+    {
+        addInterval(now - m_last_frame_ns);
+    }
+
+    m_last_frame_ns = now;
+}
+
+void FramePacer::addInterval(long long interval_ns)
+{
+    if (interval_ns > FRAME_PACER_IDLE_NS)
+        return;
+
+    double interval_ms = (double)interval_ns / 1000000.0;
+
+    m_stats_count++;
+    m_stats_sum += interval_ms;
+    m_stats_sum_sq += interval_ms * interval_ms;
+
+    if (interval_ns > m_stats_max_ns)
+    {
+        m_stats_max_ns = interval_ns;
+    }
+}
+
+float FramePacer::getMeanFrameTime()
+{
+    if (m_stats_count == 0)
+        return 0.0f;
+
+    return m_stats_sum / m_stats_count;
+}
+
+// Standard deviation of the frame time in milliseconds
+float FramePacer::getJitter()
+{
+    if (m_stats_count == 0)
+        return 0.0f;
+
+    double mean = m_stats_sum / m_stats_count;
+    double variance = m_stats_sum_sq / m_stats_count - mean * mean;
+
+    return variance > 0.0 ? std::sqrt(variance) : 0.0f;
+}
+
+float FramePacer::getMaxFrameTime()
+{
+    return (float)m_stats_max_ns / 1000000.0f;
+}
+
+void FramePacer::resetStats()
+{
+    m_stats_count = 0;
+    m_stats_sum = 0.0;
+    m_stats_sum_sq = 0.0;
+    m_stats_max_ns = 0;
+}
@@ -0,0 +1,57 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+// Frames are started at absolute deadlines, so that the time spent in a frame
+// doesn't shift the following ones. Instead of busy-waiting for the exact
+// time, the thread wakes up earlier by the oversleep measured in previous
+// frames. When vsync is active, swapping buffers already blocks until the
+// next refresh, and then the pacer only measures the frame times.
+class FramePacer
+{
+private:
+    long long m_frame_ns;
+    long long m_deadline_ns;
+    long long m_oversleep_ns;
+    long long m_last_frame_ns;
+
+    unsigned int m_stats_count;
+    double m_stats_sum;
+    double m_stats_sum_sq;
+    long long m_stats_max_ns;
+
+    long long getTime();
+    void sleepUntil(long long time_ns);
+    void addInterval(long long interval_ns);
+
+public:
+    FramePacer();
+    ~FramePacer();
+
+    void init(unsigned int max_fps);
+    void wait();
+    bool isVSyncActive();
+
+    unsigned int getFramesCount() {return m_stats_count;}
+    float getMeanFrameTime();
+    float getJitter();
+    float getMaxFrameTime();
+    void resetStats();
+};
+
+#endif
@@ -0,0 +1,314 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gl_state.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+GLState* GLState::m_gl_state = NULL;
+
+GLState::GLState()
+{
+    m_gl_state = this;
+    m_issued_count = 0;
+    m_elided_count = 0;
+    
+    GLint max_attribs = 0;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attribs);
+    m_max_attrib_arrays = std::min(max_attribs, GL_STATE_ATTRIB_ARRAYS);
+    
+    // GLES 2.0 doesn't know GL_MAJOR_VERSION, so the value is not changed
+    m_major_version = 2;
+    glGetIntegerv(GL_MAJOR_VERSION, &m_major_version);
+    glGetError();
+    
+    // Framebuffer that is bound at startup is used for the screen, which is
+    // not 0 when the device renders offscreen
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    m_default_framebuffer = framebuffer;
+
+    invalidate();
+}
+
+GLState::~GLState()
+{
+    m_gl_state = NULL;
+}
+
+// Forgets the shadow state, so that next calls are always forwarded. It
+// must be used when the GL context is recreated or when some external code
+// changed the state directly.
+void GLState::invalidate()
+{
+    m_program = -1;
+    m_array_buffer = -1;
+    m_element_array_buffer = -1;
+    m_vertex_array = -1;
+    m_framebuffer = -1;
+    m_active_texture = -1;
+
+    for (int i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+    {
+        m_textures[i] = -1;
+    }
+
+    m_attrib_arrays = 0;
+    m_default_attrib_arrays = 0;
+    m_attrib_arrays_known = false;
+    m_blend = -1;
+    m_blend_src = 0;
+    m_blend_dst = 0;
+    m_viewport[0] = 0;
+    m_viewport[1] = 0;
+    m_viewport[2] = -1;
+    m_viewport[3] = -1;
+    m_clear_color_known = false;
+}
+
+bool GLState::check(bool changed)
+{
+    if (changed)
+    {
+        m_issued_count++;
+    }
+    else
+    {
+        m_elided_count++;
+    }
+
+    return changed;
+}
+
+void GLState::useProgram(GLuint program)
+{
+    if (!check(m_program != program))
+        return;
+
+    m_program = program;
+    glUseProgram(program);
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint& current = (target == GL_ELEMENT_ARRAY_BUFFER) ? 
+                                    m_element_array_buffer : m_array_buffer;
+
+    if (!check(current != buffer))
+        return;
+
+    current = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void GLState::bindVertexArray(GLuint vertex_array)
+{
+    if (!hasVertexArrays())
+        return;
+    
+    if (!check(m_vertex_array != vertex_array))
+        return;
+
+    // Element array binding and attrib arrays are part of the vertex array
+    // state. State of the default vertex array is restored when it's bound
+    // again, and the state of other vertex arrays is not tracked.
+    if (m_vertex_array == 0)
+    {
+        m_default_attrib_arrays = m_attrib_arrays;
+    }
+
+    m_vertex_array = vertex_array;
+    glBindVertexArray(vertex_array);
+
+    m_element_array_buffer = -1;
+    m_attrib_arrays = (vertex_array == 0) ? m_default_attrib_arrays : 0;
+    m_attrib_arrays_known = (vertex_array == 0);
+}
+
+void GLState::bindFramebuffer(GLuint framebuffer)
+{
+    if (!check(m_framebuffer != framebuffer))
+        return;
+
+    m_framebuffer = framebuffer;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void GLState::activeTexture(GLenum unit)
+{
+    if (!check(m_active_texture != unit))
+        return;
+
+    m_active_texture = unit;
+    glActiveTexture(unit);
+}
+
+void GLState::bindTexture(GLuint texture)
+{
+    unsigned int unit = m_active_texture - GL_TEXTURE0;
+
+    if (unit >= GL_STATE_TEXTURE_UNITS)
+    {
+        activeTexture(GL_TEXTURE0);
+        unit = 0;
+    }
+
+    if (!check(m_textures[unit] != texture))
+        return;
+
+    m_textures[unit] = texture;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    Telemetry::getTelemetry()->addTextureBind();
+}
+
+void GLState::setAttribArrays(unsigned int mask)
+{
+    unsigned int changed = m_attrib_arrays ^ mask;
+
+    if (!m_attrib_arrays_known)
+    {
+        changed = (1u << m_max_attrib_arrays) - 1;
+    }
+
+    if (!check(changed != 0))
+        return;
+
+    for (unsigned int i = 0; i < m_max_attrib_arrays; i++)
+    {
+        if ((changed & (1u << i)) == 0)
+            continue;
+
+        if (mask & (1u << i))
+        {
+            glEnableVertexAttribArray(i);
+        }
+        else
+        {
+            glDisableVertexAttribArray(i);
+        }
+    }
+
+    m_attrib_arrays = mask;
+    m_attrib_arrays_known = true;
+}
+
+void GLState::setBlend(bool enabled)
+{
+    if (!check(m_blend != (int)enabled))
+        return;
+
+    m_blend = enabled;
+
+    if (enabled)
+    {
+        glEnable(GL_BLEND);
+    }
+    else
+    {
+        glDisable(GL_BLEND);
+    }
+}
+
+void GLState::blendFunc(GLenum src, GLenum dst)
+{
+    if (!check(m_blend_src != src || m_blend_dst != dst))
+        return;
+
+    m_blend_src = src;
+    m_blend_dst = dst;
+    glBlendFunc(src, dst);
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    GLint viewport[4] = {x, y, width, height};
+
+    if (!check(memcmp(m_viewport, viewport, sizeof(viewport)) != 0))
+        return;
+
+    memcpy(m_viewport, viewport, sizeof(viewport));
+    glViewport(x, y, width, height);
+}
+
+void GLState::clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    GLfloat color[4] = {r, g, b, a};
+
+    if (!check(!m_clear_color_known || 
+               memcmp(m_clear_color, color, sizeof(color)) != 0))
+        return;
+
+    memcpy(m_clear_color, color, sizeof(color));
+    m_clear_color_known = true;
+    glClearColor(r, g, b, a);
+}
+
+// Deleted objects are unbound by GL, so the shadow state must follow
+
+void GLState::onBufferDeleted(GLuint buffer)
+{
+    if (m_array_buffer == buffer)
+    {
+        m_array_buffer = 0;
+    }
+
+    if (m_element_array_buffer == buffer)
+    {
+        m_element_array_buffer = 0;
+    }
+}
+
+void GLState::onProgramDeleted(GLuint program)
+{
+    // Program that is in use is deleted only when it's not used anymore,
+    // but it's safer to bind it again anyway
+    if (m_program == program)
+    {
+        m_program = -1;
+    }
+}
+
+void GLState::onTextureDeleted(GLuint texture)
+{
+    for (int i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+    {
+        if (m_textures[i] == texture)
+        {
+            m_textures[i] = 0;
+        }
+    }
+}
+
+void GLState::onVertexArrayDeleted(GLuint vertex_array)
+{
+    if (m_vertex_array == vertex_array)
+    {
+        m_vertex_array = 0;
+        m_element_array_buffer = -1;
+        m_attrib_arrays = m_default_attrib_arrays;
+        m_attrib_arrays_known = true;
+    }
+}
+
+void GLState::onFramebufferDeleted(GLuint framebuffer)
+{
+    if (m_framebuffer == framebuffer)
+    {
+        m_framebuffer = 0;
+    }
+}
@@ -0,0 +1,91 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <GLES3/gl3.h>
+
+#define GL_STATE_TEXTURE_UNITS 8
+#define GL_STATE_ATTRIB_ARRAYS 16
+
+// Shadow copy of the GL state that is changed by the draw code. Calls that
+// wouldn't change anything are not forwarded to the driver. All code that
+// binds objects or toggles state should go through this class, otherwise
+// the shadow copy must be invalidated.
+class GLState
+{
+private:
+    GLuint m_program;
+    GLuint m_array_buffer;
+    GLuint m_element_array_buffer;
+    GLuint m_vertex_array;
+    GLuint m_framebuffer;
+    GLuint m_default_framebuffer;
+    GLuint m_active_texture;
+    GLuint m_textures[GL_STATE_TEXTURE_UNITS];
+    unsigned int m_attrib_arrays;
+    unsigned int m_default_attrib_arrays;
+    bool m_attrib_arrays_known;
+    unsigned int m_max_attrib_arrays;
+    int m_blend;
+    GLenum m_blend_src;
+    GLenum m_blend_dst;
+    GLint m_viewport[4];
+    GLfloat m_clear_color[4];
+    bool m_clear_color_known;
+    int m_major_version;
+    unsigned int m_issued_count;
+    unsigned int m_elided_count;
+    static GLState* m_gl_state;
+
+    bool check(bool changed);
+
+public:
+    GLState();
+    ~GLState();
+
+    void invalidate();
+    void useProgram(GLuint program);
+    void bindBuffer(GLenum target, GLuint buffer);
+    void bindVertexArray(GLuint vertex_array);
+    void bindFramebuffer(GLuint framebuffer);
+    void bindDefaultFramebuffer() {bindFramebuffer(m_default_framebuffer);}
+    void activeTexture(GLenum unit);
+    void bindTexture(GLuint texture);
+    void setAttribArrays(unsigned int mask);
+    void setBlend(bool enabled);
+    void blendFunc(GLenum src, GLenum dst);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+    void onBufferDeleted(GLuint buffer);
+    void onProgramDeleted(GLuint program);
+    void onTextureDeleted(GLuint texture);
+    void onVertexArrayDeleted(GLuint vertex_array);
+    void onFramebufferDeleted(GLuint framebuffer);
+
+    GLuint getDefaultFramebuffer() {return m_default_framebuffer;}
+    bool hasVertexArrays() {return m_major_version >= 3;}
+    bool hasInstancedArrays() {return m_major_version >= 3;}
+    unsigned int getIssuedCount() {return m_issued_count;}
+    unsigned int getElidedCount() {return m_elided_count;}
+    void resetCounters() {m_issued_count = 0; m_elided_count = 0;}
+
+    static GLState* getGLState() {return m_gl_state;}
+};
+
+#endif
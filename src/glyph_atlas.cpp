@@ -0,0 +1,136 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "glyph_atlas.hpp"
+
+#include <cstring>
+#include <vector>
+
+GlyphAtlas::GlyphAtlas()
+{
+    m_page_size = 512;
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    TextureManager* texture_manager = TextureManager::getTextureManager();
+
+    for (GlyphAtlasPage* page : m_pages)
+    {
+        if (page->owned)
+        {
+            texture_manager->deleteTexture(page->texture);
+        }
+
+        delete page;
+    }
+}
+
+void GlyphAtlas::addPage(Texture* texture, int used_height, bool owned)
+{
+    GlyphAtlasPage* page = new GlyphAtlasPage();
+    page->texture = texture;
+    page->owned = owned;
+    page->packer.init(texture->width, texture->height, used_height);
+
+    m_pages.push_back(page);
+}
+
+GlyphAtlasPage* GlyphAtlas::createPage()
+{
+    TextureManager* texture_manager = TextureManager::getTextureManager();
+
+    std::vector<unsigned char> empty(m_page_size * m_page_size, 0);
+    Texture* texture = texture_manager->createTexture(m_page_size, m_page_size,
+                                                      1, &empty[0]);
+
+    if (texture == NULL)
+        return NULL;
+
+    addPage(texture, 0, true);
+
+    return m_pages.back();
+}
+
+void GlyphAtlas::setGlyphRegion(Texture* texture, int pos_x, int pos_y,
+                                Glyph& glyph)
+{
+    float scale_x = texture->tex_w / texture->width;
+    float scale_y = texture->tex_h / texture->height;
+
+    glyph.texture = texture;
+    glyph.tex_coords[0] = pos_x * scale_x;
+    glyph.tex_coords[1] = pos_y * scale_y;
+    glyph.tex_coords[2] = (pos_x + glyph.width) * scale_x;
+    glyph.tex_coords[3] = (pos_y + glyph.height) * scale_y;
+}
+
+bool GlyphAtlas::addGlyph(int width, int height, int pitch, const void* data,
+                          Glyph& glyph)
+{
+    glyph.width = width;
+    glyph.height = height;
+
+    if (width == 0 || height == 0)
+    {
+        glyph.texture = NULL;
+        return true;
+    }
+
+    GlyphAtlasPage* page = NULL;
+    int pos_x = 0;
+    int pos_y = 0;
+
+    for (GlyphAtlasPage* p : m_pages)
+    {
+        if (p->packer.pack(width, height, &pos_x, &pos_y))
+        {
+            page = p;
+            break;
+        }
+    }
+
+    if (page == NULL)
+    {
+        page = createPage();
+
+        if (page == NULL || !page->packer.pack(width, height, &pos_x, &pos_y))
+            return false;
+    }
+
+    const unsigned char* pixels = (const unsigned char*)data;
+    std::vector<unsigned char> packed;
+
+    if (pitch != width)
+    {
+        packed.resize(width * height);
+
+        for (int i = 0; i < height; i++)
+        {
+            memcpy(&packed[i * width], pixels + i * pitch, width);
+        }
+
+        pixels = &packed[0];
+    }
+
+    TextureManager* texture_manager = TextureManager::getTextureManager();
+    texture_manager->updateTexture(page->texture, pos_x, pos_y, width, height,
+                                   pixels);
+
+    setGlyphRegion(page->texture, pos_x, pos_y, glyph);
+
+    return true;
+}
@@ -0,0 +1,61 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GLYPH_ATLAS_HPP
+#define GLYPH_ATLAS_HPP
+
+#include "font_atlas.hpp"
+#include "texture_manager.hpp"
+
+#include <vector>
+
+struct Glyph
+{
+    Texture* texture;
+    float tex_coords[4];
+    int width;
+    int height;
+    int left;
+    int top;
+    int advance;
+};
+
+struct GlyphAtlasPage
+{
+    Texture* texture;
+    ShelfPacker packer;
+    bool owned;
+};
+
+class GlyphAtlas
+{
+private:
+    std::vector<GlyphAtlasPage*> m_pages;
+    int m_page_size;
+
+    GlyphAtlasPage* createPage();
+
+public:
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    void addPage(Texture* texture, int used_height, bool owned);
+    void setGlyphRegion(Texture* texture, int pos_x, int pos_y, Glyph& glyph);
+    bool addGlyph(int width, int height, int pitch, const void* data,
+                  Glyph& glyph);
+};
+
+#endif
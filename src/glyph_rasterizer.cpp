@@ -0,0 +1,197 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "glyph_rasterizer.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+GlyphRasterizer::GlyphRasterizer()
+{
+    m_threads_count = 0;
+    m_stop = false;
+}
+
+GlyphRasterizer::~GlyphRasterizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+
+    for (GlyphWorker* worker : m_workers)
+    {
+        worker->thread.join();
+
+        for (auto& face : worker->faces)
+        {
+            FT_Done_Face(face.second);
+        }
+
+        FT_Done_FreeType(worker->ft_library);
+        delete worker;
+    }
+}
+
+bool GlyphRasterizer::init(unsigned int threads_count)
+{
+    m_threads_count = threads_count;
+
+    return m_threads_count > 0;
+}
+
+bool GlyphRasterizer::startWorkers()
+{
+    for (unsigned int i = 0; i < m_threads_count; i++)
+    {
+        GlyphWorker* worker = new GlyphWorker();
+
+        if (FT_Init_FreeType(&worker->ft_library) != 0)
+        {
+            printf("Error: Could not initialize freetype library\n");
+            delete worker;
+            break;
+        }
+
+        worker->thread = std::thread(&GlyphRasterizer::run, this, worker);
+        m_workers.push_back(worker);
+    }
+
+    return !m_workers.empty();
+}
+
+bool GlyphRasterizer::requestGlyph(FontData* font, const File* font_file,
+                                   unsigned int codepoint, int size)
+{
+    if (m_workers.empty() && !startWorkers())
+        return false;
+
+    GlyphJob job;
+    job.font = font;
+    job.font_file = font_file;
+    job.codepoint = codepoint;
+    job.size = size;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(job);
+    }
+
+    m_condition.notify_one();
+
+    return true;
+}
+
+void GlyphRasterizer::getResults(std::vector<GlyphBitmap>& results)
+{
+    results.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    results.swap(m_results);
+}
+
+void GlyphRasterizer::run(GlyphWorker* worker)
+{
+    while (true)
+    {
+        GlyphJob job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] {return m_stop || !m_jobs.empty();});
+
+            if (m_stop)
+                break;
+
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        GlyphBitmap bitmap;
+        renderGlyph(worker, job, bitmap);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back(std::move(bitmap));
+    }
+}
+
+FT_Face GlyphRasterizer::getFace(GlyphWorker* worker, const File* font_file)
+{
+    auto it = worker->faces.find(font_file);
+
+    if (it != worker->faces.end())
+        return it->second;
+
+    FT_Face ft_face = NULL;
+    int err = FT_New_Memory_Face(worker->ft_library, 
+                                 (const FT_Byte*)font_file->data,
+                                 font_file->length, 0, &ft_face);
+
+    if (err != 0)
+    {
+        ft_face = NULL;
+    }
+    else
+    {
+        FT_Select_Charmap(ft_face, ft_encoding_unicode);
+    }
+
+    worker->faces[font_file] = ft_face;
+    return ft_face;
+}
+
+void GlyphRasterizer::renderGlyph(GlyphWorker* worker, const GlyphJob& job,
+                                  GlyphBitmap& bitmap)
+{
+    bitmap.font = job.font;
+    bitmap.codepoint = job.codepoint;
+    bitmap.size = job.size;
+    bitmap.width = 0;
+    bitmap.height = 0;
+    bitmap.left = 0;
+    bitmap.top = 0;
+    bitmap.advance = 0;
+    bitmap.success = false;
+
+    FT_Face ft_face = getFace(worker, job.font_file);
+
+    if (ft_face == NULL)
+        return;
+
+    FT_Set_Pixel_Sizes(ft_face, 0, job.size);
+
+    if (FT_Load_Char(ft_face, job.codepoint, FT_LOAD_RENDER))
+        return;
+
+    FT_GlyphSlot g = ft_face->glyph;
+
+    bitmap.width = g->bitmap.width;
+    bitmap.height = g->bitmap.rows;
+    bitmap.left = g->bitmap_left;
+    bitmap.top = g->bitmap_top;
+    bitmap.advance = g->advance.x / 64;
+    bitmap.success = true;
+
+    bitmap.pixels.resize(bitmap.width * bitmap.height);
+
+    for (int i = 0; i < bitmap.height; i++)
+    {
+        memcpy(&bitmap.pixels[i * bitmap.width], 
+               g->bitmap.buffer + i * g->bitmap.pitch, bitmap.width);
+    }
+}
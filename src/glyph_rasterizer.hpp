@@ -0,0 +1,96 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GLYPH_RASTERIZER_HPP
+#define GLYPH_RASTERIZER_HPP
+
+#include "file_manager.hpp"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct FontData;
+
+struct GlyphJob
+{
+    FontData* font;
+    const File* font_file;
+    unsigned int codepoint;
+    int size;
+};
+
+struct GlyphBitmap
+{
+    FontData* font;
+    unsigned int codepoint;
+    int size;
+    int width;
+    int height;
+    int left;
+    int top;
+    int advance;
+    bool success;
+    std::vector<unsigned char> pixels;
+};
+
+struct GlyphWorker
+{
+    std::thread thread;
+    FT_Library ft_library;
+    std::map<const File*, FT_Face> faces;
+};
+
+// Renders glyphs with freetype on worker threads. Every worker has its own
+// freetype library and faces created from the shared font data, so that
+// no locking is needed around freetype. Rendered bitmaps are collected by
+// the render thread, which uploads them to the glyph atlas. The workers are
+// started when the first glyph is requested, so that nothing is created at
+// startup when all glyphs come from the prebaked atlas.
+class GlyphRasterizer
+{
+private:
+    std::vector<GlyphWorker*> m_workers;
+    std::deque<GlyphJob> m_jobs;
+    std::vector<GlyphBitmap> m_results;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    unsigned int m_threads_count;
+    bool m_stop;
+
+    bool startWorkers();
+    void run(GlyphWorker* worker);
+    FT_Face getFace(GlyphWorker* worker, const File* font_file);
+    void renderGlyph(GlyphWorker* worker, const GlyphJob& job,
+                     GlyphBitmap& bitmap);
+
+public:
+    GlyphRasterizer();
+    ~GlyphRasterizer();
+
+    bool init(unsigned int threads_count);
+    bool requestGlyph(FontData* font, const File* font_file,
+                      unsigned int codepoint, int size);
+    void getResults(std::vector<GlyphBitmap>& results);
+};
+
+#endif
@@ -19,6 +19,8 @@
 #include "image_loader_jpg.hpp"
 #include "image_loader_png.hpp"
 
+#include <cstdio>
+
 Image* ImageLoader::loadImage(std::string filename)
 {
     Image* image = NULL;
@@ -46,3 +48,17 @@ void ImageLoader::closeImage(Image* image)
     delete[] image->data;
     delete image;
 }
+
+// Saves image directly to the file system, not to the assets
+bool ImageLoader::saveImage(std::string path, const Image* image)
+{
+    FileManager* file_manager = FileManager::getFileManager();
+    std::string extension = file_manager->getExtension(path);
+    
+    if (extension == ".png")
+        return ImageLoaderPNG::saveImage(path, image);
+    
+    printf("Error: Unsupported image format: %s\n", path.c_str());
+    
+    return false;
+}
@@ -33,6 +33,7 @@ class ImageLoader
 public:
     static Image* loadImage(std::string filename);
     static void closeImage(Image* image);
+    static bool saveImage(std::string path, const Image* image);
 };
 
 #endif
@@ -68,9 +68,11 @@ Image* ImageLoaderPNG::loadImage(std::string filename)
     png_byte color_type = png_get_color_type(png_ptr, info_ptr);
     png_byte bit_depth = png_get_bit_depth(png_ptr, info_ptr);
     
-    if (color_type != PNG_COLOR_TYPE_RGB && color_type != PNG_COLOR_TYPE_RGBA)
+    if (color_type != PNG_COLOR_TYPE_RGB && color_type != PNG_COLOR_TYPE_RGBA &&
+        color_type != PNG_COLOR_TYPE_GRAY)
     {
-        printf("Error: Unsupported png format. It must be RGB or RGBA\n");
+        printf("Error: Unsupported png format. It must be RGB, RGBA or "
+               "grayscale\n");
         file_manager->closeFile(file);
         png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
         return NULL;
@@ -132,3 +134,73 @@ Image* ImageLoaderPNG::loadImage(std::string filename)
     
     return image;
 }
+
+bool ImageLoaderPNG::saveImage(std::string path, const Image* image)
+{
+    int color_type = 0;
+    
+    switch (image->channels)
+    {
+    case 1:
+        color_type = PNG_COLOR_TYPE_GRAY;
+        break;
+    case 3:
+        color_type = PNG_COLOR_TYPE_RGB;
+        break;
+    case 4:
+        color_type = PNG_COLOR_TYPE_RGB_ALPHA;
+        break;
+    default:
+        printf("Error: Unsupported number of channels: %i\n", 
+               image->channels);
+        return false;
+    }
+    
+    FILE* file = fopen(path.c_str(), "wb");
+    
+    if (file == NULL)
+    {
+        printf("Error: Couldn't open file for writing: %s\n", path.c_str());
+        return false;
+    }
+    
+    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL,
+                                                  NULL, NULL);
+
+    if (!png_ptr)
+    {
+        printf("Error: png_create_write_struct failed\n");
+        fclose(file);
+        return false;
+    }
+
+    png_infop info_ptr = png_create_info_struct(png_ptr);
+
+    if (!info_ptr)
+    {
+        printf("Error: png_create_info_struct failed\n");
+        png_destroy_write_struct(&png_ptr, NULL);
+        fclose(file);
+        return false;
+    }
+    
+    png_init_io(png_ptr, file);
+    png_set_IHDR(png_ptr, info_ptr, image->width, image->height, 8, 
+                 color_type, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+                 PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png_ptr, info_ptr);
+    
+    int pitch = image->width * image->channels;
+    
+    for (int i = 0; i < image->height; i++)
+    {
+        png_write_row(png_ptr, &image->data[i * pitch]);
+    }
+    
+    png_write_end(png_ptr, NULL);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    
+    fclose(file);
+    
+    return true;
+}
@@ -33,6 +33,7 @@ private:
 
 public:
     static Image* loadImage(std::string filename);
+    static bool saveImage(std::string path, const Image* image);
 };
 
 #endif
@@ -0,0 +1,151 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "job_queue.hpp"
+#include "telemetry.hpp"
+
+#include <ctime>
+
+JobQueue* JobQueue::m_job_queue = NULL;
+
+JobQueue::JobQueue()
+{
+    m_budget_us = 4000;
+    m_missed_deadlines = 0;
+    m_job_queue = this;
+}
+
+JobQueue::~JobQueue()
+{
+    m_job_queue = NULL;
+}
+
+unsigned long JobQueue::getTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long)(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+// Deadline of 0 means that the job can wait as long as it's needed
+void JobQueue::addJob(JobFunction function, JobPriority priority,
+                      unsigned int deadline_ms)
+{
+    Job job;
+    job.function = function;
+    job.deadline = 0;
+
+    if (deadline_ms > 0)
+    {
+        job.deadline = getTime() + deadline_ms * 1000;
+    }
+
+    m_jobs[priority].push_back(job);
+}
+
+std::deque<Job>* JobQueue::getNextQueue(unsigned long now)
+{
+    std::deque<Job>* next = NULL;
+    unsigned long earliest_deadline = 0;
+
+    for (unsigned int i = 0; i < JP_COUNT; i++)
+    {
+        if (m_jobs[i].empty())
+            continue;
+
+        unsigned long deadline = m_jobs[i].front().deadline;
+
+        if (deadline == 0 || deadline > now)
+            continue;
+
+        if (next == NULL || deadline < earliest_deadline)
+        {
+            next = &m_jobs[i];
+            earliest_deadline = deadline;
+        }
+    }
+
+    if (next != NULL)
+        return next;
+
+    for (unsigned int i = 0; i < JP_COUNT; i++)
+    {
+        if (!m_jobs[i].empty())
+            return &m_jobs[i];
+    }
+
+    return NULL;
+}
+
+// Runs at least one step, so that the jobs make progress even if a single
+// step takes longer than the budget. Returns true if anything was run.
+bool JobQueue::run()
+{
+    unsigned long start = getTime();
+    bool result = false;
+
+    while (true)
+    {
+        unsigned long now = getTime();
+
+        if (result && now - start >= m_budget_us)
+            break;
+
+        std::deque<Job>* queue = getNextQueue(now);
+
+        if (queue == NULL)
+            break;
+
+        // The job may add new jobs, so it's taken out of the queue first
+        Job job = queue->front();
+        queue->pop_front();
+
+        bool finished = job.function();
+        result = true;
+
+        if (!finished)
+        {
+            queue->push_front(job);
+        }
+        else if (job.deadline != 0 && getTime() > job.deadline)
+        {
+            m_missed_deadlines++;
+            Telemetry::getTelemetry()->addMissedDeadline();
+        }
+    }
+
+    return result;
+}
+
+bool JobQueue::hasJobs()
+{
+    for (unsigned int i = 0; i < JP_COUNT; i++)
+    {
+        if (!m_jobs[i].empty())
+            return true;
+    }
+
+    return false;
+}
+
+void JobQueue::clear()
+{
+    for (unsigned int i = 0; i < JP_COUNT; i++)
+    {
+        m_jobs[i].clear();
+    }
+}
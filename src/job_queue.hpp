@@ -0,0 +1,75 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JOB_QUEUE_HPP
+#define JOB_QUEUE_HPP
+
+#include <deque>
+#include <functional>
+
+enum JobPriority
+{
+    JP_HIGH,
+    JP_NORMAL,
+    JP_LOW,
+    JP_COUNT
+};
+
+// Returns true when the job is finished. Otherwise it's called again, so
+// that long work can be split into small steps.
+typedef std::function<bool()> JobFunction;
+
+struct Job
+{
+    JobFunction function;
+    unsigned long deadline;
+};
+
+// Work that has to be done on the main thread, e.g. uploads to GL textures.
+// Jobs are run once per frame until the time budget is spent, so that long
+// batches are spread over several frames and short ones finish in a single
+// frame. Jobs with expired deadline are run before the others, and then
+// jobs are taken by priority in the order in which they were added.
+class JobQueue
+{
+private:
+    std::deque<Job> m_jobs[JP_COUNT];
+    unsigned long m_budget_us;
+    unsigned int m_missed_deadlines;
+
+    static JobQueue* m_job_queue;
+
+    unsigned long getTime();
+    std::deque<Job>* getNextQueue(unsigned long now);
+
+public:
+    JobQueue();
+    ~JobQueue();
+
+    void addJob(JobFunction function, JobPriority priority = JP_NORMAL,
+                unsigned int deadline_ms = 0);
+    bool run();
+    bool hasJobs();
+    void clear();
+    void setBudget(unsigned int budget_us) {m_budget_us = budget_us;}
+    unsigned int getBudget() {return m_budget_us;}
+    unsigned int getMissedDeadlines() {return m_missed_deadlines;}
+    void resetMissedDeadlines() {m_missed_deadlines = 0;}
+
+    static JobQueue* getJobQueue() {return m_job_queue;}
+};
+
+#endif
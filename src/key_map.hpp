@@ -0,0 +1,110 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef KEY_MAP_HPP
+#define KEY_MAP_HPP
+
+#include "events.hpp"
+
+#include <algorithm>
+
+struct KeyMapEntry
+{
+    int code;
+    KeyId id;
+};
+
+inline bool operator<(const KeyMapEntry& entry, int code)
+{
+    return entry.code < code;
+}
+
+template<int Size>
+struct KeyTable
+{
+    KeyId ids[Size];
+};
+
+template<int... I>
+struct KeyIndexList {};
+
+template<int N, int... I>
+struct MakeKeyIndexList : MakeKeyIndexList<N - 1, N - 1, I...> {};
+
+template<int... I>
+struct MakeKeyIndexList<0, I...>
+{
+    typedef KeyIndexList<I...> type;
+};
+
+// Linear search, but it's only used at compile time to fill the tables
+template<int N>
+constexpr KeyId findKeyId(const KeyMapEntry (&entries)[N], int code, 
+                          int i = 0)
+{
+    return i == N ? KC_KEY_UNKNOWN :
+           entries[i].code == code ? entries[i].id :
+           findKeyId(entries, code, i + 1);
+}
+
+template<int N, int... I>
+constexpr KeyTable<sizeof...(I)> expandKeyTable(
+                                const KeyMapEntry (&entries)[N], int first, 
+                                KeyIndexList<I...>)
+{
+    return {{findKeyId(entries, first + I)...}};
+}
+
+// Expands the entries into a dense table for codes from first to
+// first + Size - 1, so that a key is translated with a single array access
+template<int Size, int N>
+constexpr KeyTable<Size> makeKeyTable(const KeyMapEntry (&entries)[N], 
+                                      int first)
+{
+    return expandKeyTable(entries, first, 
+                          typename MakeKeyIndexList<Size>::type());
+}
+
+template<int N>
+constexpr int countKeysInRange(const KeyMapEntry (&entries)[N], int first, 
+                               int last, int i = 0)
+{
+    return i == N ? 0 :
+           (entries[i].code >= first && entries[i].code <= last ? 1 : 0) + 
+           countKeysInRange(entries, first, last, i + 1);
+}
+
+template<int N>
+constexpr bool areKeysSorted(const KeyMapEntry (&entries)[N], int i = 1)
+{
+    return i >= N || (entries[i - 1].code < entries[i].code && 
+                      areKeysSorted(entries, i + 1));
+}
+
+// Binary search in entries sorted by code, for the few codes that are too
+// far from the others to be put in a dense table
+template<int N>
+KeyId findSparseKeyId(const KeyMapEntry (&entries)[N], int code)
+{
+    const KeyMapEntry* entry = std::lower_bound(entries, entries + N, code);
+
+    if (entry == entries + N || entry->code != code)
+        return KC_KEY_UNKNOWN;
+
+    return entry->id;
+}
+
+#endif
@@ -0,0 +1,140 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_manager.hpp"
+#include "draw_utils.hpp"
+#include "font_manager.hpp"
+#include "gl_state.hpp"
+#include "layer_cache.hpp"
+#include "render_target.hpp"
+
+#include <cstdio>
+
+LayerCache::LayerCache()
+{
+    m_render_target = NULL;
+    m_texture.id = 0;
+    m_texture.width = 0;
+    m_texture.height = 0;
+    m_texture.tex_w = 1.0f;
+    m_texture.tex_h = 1.0f;
+    m_texture.channels = 3;
+    m_texture.alpha = TA_OPAQUE;
+    m_window_width = 0;
+    m_window_height = 0;
+    m_atlas_generation = 0;
+    m_supported = true;
+}
+
+LayerCache::~LayerCache()
+{
+    delete m_render_target;
+}
+
+// Text in the layer is drawn with the glyphs that are available at the
+// moment, so the layer is rebuilt when new glyphs are rendered
+bool LayerCache::isOutdated()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    FontManager* font_manager = FontManager::getFontManager();
+
+    return device->getWindowWidth() != m_window_width ||
+           device->getWindowHeight() != m_window_height ||
+           font_manager->getAtlasGeneration() != m_atlas_generation;
+}
+
+// Returns false if the layer can't be used, and then the parts that would be
+// cached should be drawn directly
+bool LayerCache::begin()
+{
+    if (!m_supported)
+        return false;
+
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    unsigned int window_w = device->getWindowWidth();
+    unsigned int window_h = device->getWindowHeight();
+
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+    draw_utils->flush();
+
+    if (m_render_target == NULL || window_w != m_window_width ||
+        window_h != m_window_height)
+    {
+        if (m_render_target == NULL)
+        {
+            m_render_target = new RenderTarget();
+        }
+
+        bool success = m_render_target->init(window_w, window_h, false);
+
+        if (!success)
+        {
+            printf("Warning: Couldn't create layer cache.\n");
+            delete m_render_target;
+            m_render_target = NULL;
+            m_supported = false;
+
+            GLState::getGLState()->bindDefaultFramebuffer();
+            return false;
+        }
+    }
+
+    m_window_width = window_w;
+    m_window_height = window_h;
+
+    m_texture.id = m_render_target->getTexture();
+    m_texture.width = window_w;
+    m_texture.height = window_h;
+
+    m_render_target->bind();
+
+    GLState* gl_state = GLState::getGLState();
+    gl_state->clearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    return true;
+}
+
+void LayerCache::end()
+{
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+    draw_utils->flush();
+
+    m_render_target->unbind();
+
+    GLState* gl_state = GLState::getGLState();
+    gl_state->viewport(0, 0, m_window_width, m_window_height);
+
+    FontManager* font_manager = FontManager::getFontManager();
+    m_atlas_generation = font_manager->getAtlasGeneration();
+}
+
+void LayerCache::draw()
+{
+    if (m_render_target == NULL)
+        return;
+
+    // Framebuffer texture has the first row at the bottom
+    float tex_coords[4] = {0.0f, 1.0f, 1.0f, 0.0f};
+    GLfloat color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    // Everything else is drawn on top of the layer, so it can't wait for
+    // sorting in the sprite batch
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+    draw_utils->submit(&m_texture, SPRITE_TEXTURE, 0, 0, m_window_width,
+                       m_window_height, tex_coords, color);
+    draw_utils->flush();
+}
@@ -0,0 +1,49 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef LAYER_CACHE_HPP
+#define LAYER_CACHE_HPP
+
+#include "texture_manager.hpp"
+
+class RenderTarget;
+
+// Part of the scene that only changes on window resize, rendered once into
+// a texture. Everything that is drawn between begin() and end() goes to the
+// layer, and draw() puts it on the screen with a single opaque quad, so that
+// the overdraw of the cached parts is paid only when the layer is rebuilt.
+class LayerCache
+{
+private:
+    RenderTarget* m_render_target;
+    Texture m_texture;
+    unsigned int m_window_width;
+    unsigned int m_window_height;
+    unsigned int m_atlas_generation;
+    bool m_supported;
+
+public:
+    LayerCache();
+    ~LayerCache();
+
+    bool begin();
+    void end();
+    void draw();
+    bool isOutdated();
+    bool isReady() {return m_supported && !isOutdated();}
+};
+
+#endif
@@ -0,0 +1,195 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_manager.hpp"
+#include "layout.hpp"
+
+#include <cassert>
+
+Layout::Layout()
+{
+    m_reference_height = 600.0f;
+    m_scale = 1.0f;
+    m_window_width = 0;
+    m_window_height = 0;
+    m_dirty = true;
+}
+
+Layout::~Layout()
+{
+}
+
+void Layout::init(float reference_height)
+{
+    m_reference_height = reference_height;
+    m_dirty = true;
+}
+
+int Layout::addNode(int parent)
+{
+    assert(parent < (int)m_nodes.size());
+
+    LayoutNode node;
+    node.parent = parent;
+    node.anchor_x = 0.0f;
+    node.anchor_y = 0.0f;
+    node.pivot_x = 0.0f;
+    node.pivot_y = 0.0f;
+    node.offset_x = 0.0f;
+    node.offset_y = 0.0f;
+    node.width = 0.0f;
+    node.height = 0.0f;
+    node.rel_width = 0.0f;
+    node.rel_height = 0.0f;
+    node.aspect_w = 0.0f;
+    node.aspect_h = 0.0f;
+    node.content_width = 0;
+    node.content_height = 0;
+    node.rect.x = 0;
+    node.rect.y = 0;
+    node.rect.width = 0;
+    node.rect.height = 0;
+
+    m_nodes.push_back(node);
+    m_dirty = true;
+
+    return m_nodes.size() - 1;
+}
+
+void Layout::setAnchor(int id, float anchor_x, float anchor_y, float pivot_x,
+                       float pivot_y)
+{
+    LayoutNode& node = m_nodes[id];
+    node.anchor_x = anchor_x;
+    node.anchor_y = anchor_y;
+    node.pivot_x = pivot_x;
+    node.pivot_y = pivot_y;
+    m_dirty = true;
+}
+
+void Layout::setOffset(int id, float offset_x, float offset_y)
+{
+    LayoutNode& node = m_nodes[id];
+    node.offset_x = offset_x;
+    node.offset_y = offset_y;
+    m_dirty = true;
+}
+
+void Layout::setSize(int id, float width, float height, float rel_width,
+                     float rel_height)
+{
+    LayoutNode& node = m_nodes[id];
+    node.width = width;
+    node.height = height;
+    node.rel_width = rel_width;
+    node.rel_height = rel_height;
+    m_dirty = true;
+}
+
+// The height is computed from the width, so that images keep their shape
+void Layout::setAspect(int id, float aspect_w, float aspect_h)
+{
+    LayoutNode& node = m_nodes[id];
+    node.aspect_w = aspect_w;
+    node.aspect_h = aspect_h;
+    m_dirty = true;
+}
+
+// Size in pixels that is added to the node size, e.g. the width of a text.
+// It's called when the content changes, so it's a no-op for the same size.
+void Layout::setContentSize(int id, int width, int height)
+{
+    LayoutNode& node = m_nodes[id];
+
+    if (node.content_width == width && node.content_height == height)
+        return;
+
+    node.content_width = width;
+    node.content_height = height;
+    m_dirty = true;
+}
+
+bool Layout::isOutdated()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+
+    return m_dirty ||
+           device->getWindowWidth() != m_window_width ||
+           device->getWindowHeight() != m_window_height;
+}
+
+void Layout::computeNode(LayoutNode& node)
+{
+    LayoutRect parent_rect;
+
+    if (node.parent >= 0)
+    {
+        parent_rect = m_nodes[node.parent].rect;
+    }
+    else
+    {
+        parent_rect.x = 0;
+        parent_rect.y = 0;
+        parent_rect.width = m_window_width;
+        parent_rect.height = m_window_height;
+    }
+
+    LayoutRect& rect = node.rect;
+
+    rect.width = node.rel_width * parent_rect.width + node.width * m_scale;
+    rect.width += node.content_width;
+
+    if (node.aspect_w > 0.0f)
+    {
+        rect.height = rect.width * node.aspect_h / node.aspect_w;
+    }
+    else
+    {
+        rect.height = node.rel_height * parent_rect.height +
+                      node.height * m_scale;
+        rect.height += node.content_height;
+    }
+
+    rect.x = parent_rect.x + (int)(node.anchor_x * parent_rect.width -
+                                   node.pivot_x * rect.width +
+                                   node.offset_x * m_scale);
+    rect.y = parent_rect.y + (int)(node.anchor_y * parent_rect.height -
+                                   node.pivot_y * rect.height +
+                                   node.offset_y * m_scale);
+}
+
+void Layout::update()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    m_window_width = device->getWindowWidth();
+    m_window_height = device->getWindowHeight();
+    m_scale = (float)m_window_height / m_reference_height;
+
+    for (LayoutNode& node : m_nodes)
+    {
+        computeNode(node);
+    }
+
+    m_dirty = false;
+}
+
+bool Layout::isPointInside(int id, int pos_x, int pos_y)
+{
+    const LayoutRect& rect = m_nodes[id].rect;
+
+    return (pos_x >= rect.x && pos_x <= rect.x + rect.width &&
+            pos_y >= rect.y && pos_y <= rect.y + rect.height);
+}
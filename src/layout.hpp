@@ -0,0 +1,91 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP
+
+#include <vector>
+
+struct LayoutRect
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// A node is placed by pinning its pivot point to the anchor point of the
+// parent. Both are fractions of the size (0 is left/top, 1 is right/bottom).
+// Offsets and sizes are in gui units, which are scaled with the window
+// height, and the size can also follow the parent size, the aspect ratio of
+// an image or the size of the content in pixels.
+struct LayoutNode
+{
+    int parent;
+    float anchor_x;
+    float anchor_y;
+    float pivot_x;
+    float pivot_y;
+    float offset_x;
+    float offset_y;
+    float width;
+    float height;
+    float rel_width;
+    float rel_height;
+    float aspect_w;
+    float aspect_h;
+    int content_width;
+    int content_height;
+    LayoutRect rect;
+};
+
+// The tree is computed only when the window size or one of the nodes has
+// changed, and the cached rectangles are used for drawing and hit-testing.
+// Parents have to be added before their children, so that the whole tree
+// is computed in a single pass.
+class Layout
+{
+private:
+    std::vector<LayoutNode> m_nodes;
+    float m_reference_height;
+    float m_scale;
+    unsigned int m_window_width;
+    unsigned int m_window_height;
+    bool m_dirty;
+
+    void computeNode(LayoutNode& node);
+
+public:
+    Layout();
+    ~Layout();
+
+    void init(float reference_height);
+    int addNode(int parent = -1);
+    void setAnchor(int id, float anchor_x, float anchor_y, float pivot_x,
+                   float pivot_y);
+    void setOffset(int id, float offset_x, float offset_y);
+    void setSize(int id, float width, float height, float rel_width = 0.0f,
+                 float rel_height = 0.0f);
+    void setAspect(int id, float aspect_w, float aspect_h);
+    void setContentSize(int id, int width, int height);
+    bool isOutdated();
+    void update();
+    bool isPointInside(int id, int pos_x, int pos_y);
+    const LayoutRect& getRect(int id) {return m_nodes[id].rect;}
+    float getScale() {return m_scale;}
+};
+
+#endif
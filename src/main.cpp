@@ -18,11 +18,18 @@
 #include <cstdlib>
 
 #include "device_android.hpp"
+#include "device_headless.hpp"
 #include "device_manager.hpp"
 #include "draw_utils.hpp"
 #include "font_manager.hpp"
+#include "frame_pacer.hpp"
+#include "gl_state.hpp"
+#include "job_queue.hpp"
+#include "profiler.hpp"
+#include "program_cache.hpp"
 #include "texture_manager.hpp"
 #include "scene_manager.hpp"
+#include "telemetry.hpp"
 
 #ifdef ANDROID
 struct android_app* g_android_app;
@@ -33,6 +40,7 @@ void main_loop()
     #ifdef DEBUG_FPS
     float dbg_counter = 0;
     unsigned int frames_count = 0;
+    std::clock_t dbg_cpu_time = std::clock();
     #endif
     
     bool close = false;
@@ -40,57 +48,115 @@ void main_loop()
 
     SceneManager* scene_manager = SceneManager::getSceneManager();
     Device* device = DeviceManager::getDeviceManager()->getDevice();
+    Telemetry* telemetry = Telemetry::getTelemetry();
+    
+    FramePacer frame_pacer;
+    frame_pacer.init(max_fps);
     
-    unsigned long ticks_per_frame = (unsigned long)(1000000.0f / max_fps);
     unsigned long base_ticks = device->getMicroTickCount();
     unsigned long current_ticks = 0;
 
     while (!close)
     {
-        unsigned long ticks = device->getMicroTickCount() - base_ticks;
-
-        if (ticks > current_ticks && ticks < current_ticks + ticks_per_frame)
-        {
-            unsigned long sleep_us = current_ticks - ticks + ticks_per_frame;
-            int sleep_ms = sleep_us / 1000;
-
-            if (sleep_ms > 0)
-            {
-                device->sleep(sleep_ms);
-            }
-
-            while (device->getMicroTickCount() - base_ticks < current_ticks +
-                   ticks_per_frame)
-            {
-                device->sleep(0);
-            }
-        }
+        frame_pacer.wait();
 
         unsigned long old_ticks = current_ticks;
         current_ticks = device->getMicroTickCount() - base_ticks;
         float dt = (float)(current_ticks - old_ticks) / 1000000.0f;
 
         close = scene_manager->update(dt);
+        
+        // Only the iterations that drew something are counted as frames
+        if (telemetry->endFrame())
+        {
+            #ifdef DEBUG_FPS
+            frames_count++;
+            #endif
+        }
 
         #ifdef DEBUG_FPS
         if (dbg_counter >= 1.0f)
         {
             float fps = (float)frames_count / dbg_counter;
             printf("fps: %f\n", fps);
+            
+            std::clock_t cpu_time = std::clock();
+            float cpu_usage = (float)(cpu_time - dbg_cpu_time) / 
+                              CLOCKS_PER_SEC / dbg_counter * 100.0f;
+            printf("frame time: %.3f ms mean, %.3f ms jitter, %.3f ms max, "
+                   "cpu: %.1f%%\n", frame_pacer.getMeanFrameTime(),
+                   frame_pacer.getJitter(), frame_pacer.getMaxFrameTime(),
+                   cpu_usage);
+            frame_pacer.resetStats();
+            dbg_cpu_time = cpu_time;
+            
+            // There may be no frames at all while the screen is static
+            GLState* gl_state = GLState::getGLState();
+            
+            if (frames_count > 0)
+            {
+                printf("gl calls per frame: %u issued, %u elided\n",
+                       gl_state->getIssuedCount() / frames_count,
+                       gl_state->getElidedCount() / frames_count);
+            }
+            
+            gl_state->resetCounters();
+            
+            JobQueue* job_queue = JobQueue::getJobQueue();
+            printf("jobs: %u missed deadlines, %u us budget\n", 
+                   job_queue->getMissedDeadlines(), job_queue->getBudget());
+            job_queue->resetMissedDeadlines();
+            
             frames_count = 0;
             dbg_counter = 0;
         }
 
         dbg_counter += dt;
-        frames_count++;
         #endif
     }
 }
 
 int main(int argc, char *argv[])
 {
+    std::string profile_path;
+    std::string telemetry_path;
+    bool headless = false;
+    unsigned int headless_frames = 0;
+    int job_budget = -1;
+    std::string dump_path;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        
+        if (arg == "--profile" && i + 1 < argc)
+        {
+            profile_path = argv[++i];
+        }
+        else if (arg == "--telemetry" && i + 1 < argc)
+        {
+            telemetry_path = argv[++i];
+        }
+        else if (arg == "--headless")
+        {
+            headless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            headless_frames = atoi(argv[++i]);
+        }
+        else if (arg == "--dump" && i + 1 < argc)
+        {
+            dump_path = argv[++i];
+        }
+        else if (arg == "--job-budget" && i + 1 < argc)
+        {
+            job_budget = atoi(argv[++i]);
+        }
+    }
+    
     DeviceManager* device_manager = new DeviceManager();
-    bool success = device_manager->init();
+    bool success = device_manager->init(headless);
     
     if (!success)
     {
@@ -98,6 +164,13 @@ int main(int argc, char *argv[])
         return 1;
     }
     
+    if (headless)
+    {
+        DeviceHeadless* device = (DeviceHeadless*)device_manager->getDevice();
+        device->setFramesLimit(headless_frames);
+        device->setDumpPath(dump_path);
+    }
+    
     FileManager* file_manager = new FileManager();
     success = file_manager->init();
     
@@ -107,6 +180,25 @@ int main(int argc, char *argv[])
         return 1;
     }
     
+    GLState* gl_state = new GLState();
+    
+    Telemetry* telemetry = new Telemetry();
+    telemetry->setExportPath(telemetry_path);
+    
+    Profiler* profiler = new Profiler();
+    profiler->init();
+    profiler->setExportPath(profile_path);
+    
+    ProgramCache* program_cache = new ProgramCache();
+    program_cache->init();
+    
+    JobQueue* job_queue = new JobQueue();
+    
+    if (job_budget > 0)
+    {
+        job_queue->setBudget(job_budget);
+    }
+    
     DrawUtils* draw_utils = new DrawUtils();
     success = draw_utils->init();
     
@@ -147,10 +239,25 @@ int main(int argc, char *argv[])
     
     main_loop();
     
+    if (!profiler->getExportPath().empty())
+    {
+        profiler->exportToFile(profiler->getExportPath());
+    }
+    
+    if (!telemetry->getExportPath().empty())
+    {
+        telemetry->exportToFile(telemetry->getExportPath());
+    }
+    
+    delete job_queue;
     delete scene_manager;
     delete font_manager;
     delete texture_manager;
     delete draw_utils;
+    delete program_cache;
+    delete profiler;
+    delete telemetry;
+    delete gl_state;
     delete file_manager;
     delete device_manager;
 
@@ -0,0 +1,404 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_manager.hpp"
+#include "font_manager.hpp"
+#include "profiler.hpp"
+
+#include <EGL/egl.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+Profiler* Profiler::m_profiler = NULL;
+
+static const char* g_section_names[PS_COUNT] =
+{
+    "frame",
+    "events",
+    "jobs",
+    "scene update",
+    "extraction",
+    "draw static",
+    "draw text",
+    "draw buttons",
+    "draw progress",
+    "draw flush",
+    "swap",
+    "gpu"
+};
+
+Profiler::Profiler()
+{
+    m_profiler = this;
+    m_frame = 0;
+    m_frames_count = 0;
+    m_in_frame = false;
+    m_overlay_visible = false;
+    m_gpu_supported = false;
+    m_gpu_current = NULL;
+    
+    m_gen_queries = NULL;
+    m_delete_queries = NULL;
+    m_begin_query = NULL;
+    m_end_query = NULL;
+    m_get_query_objectuiv = NULL;
+    m_get_query_objectui64v = NULL;
+    
+    memset(m_history, 0, sizeof(m_history));
+    memset(m_start, 0, sizeof(m_start));
+    memset(m_gpu_queries, 0, sizeof(m_gpu_queries));
+}
+
+Profiler::~Profiler()
+{
+    if (m_gpu_supported)
+    {
+        for (int i = 0; i < PROFILER_GPU_QUERIES; i++)
+        {
+            m_delete_queries(1, &m_gpu_queries[i].id);
+        }
+    }
+}
+
+bool Profiler::init()
+{
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    
+    if (extensions == NULL || 
+        strstr(extensions, "GL_EXT_disjoint_timer_query") == NULL)
+    {
+        printf("Warning: GPU timer queries are not supported.\n");
+        return true;
+    }
+    
+    m_gen_queries = (PFNGLGENQUERIESEXTPROC)
+                                    eglGetProcAddress("glGenQueriesEXT");
+    m_delete_queries = (PFNGLDELETEQUERIESEXTPROC)
+                                    eglGetProcAddress("glDeleteQueriesEXT");
+    m_begin_query = (PFNGLBEGINQUERYEXTPROC)
+                                    eglGetProcAddress("glBeginQueryEXT");
+    m_end_query = (PFNGLENDQUERYEXTPROC)
+                                    eglGetProcAddress("glEndQueryEXT");
+    m_get_query_objectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)
+                            eglGetProcAddress("glGetQueryObjectuivEXT");
+    m_get_query_objectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)
+                            eglGetProcAddress("glGetQueryObjectui64vEXT");
+                            
+    if (m_gen_queries == NULL || m_delete_queries == NULL || 
+        m_begin_query == NULL || m_end_query == NULL || 
+        m_get_query_objectuiv == NULL || m_get_query_objectui64v == NULL)
+    {
+        printf("Warning: Couldn't load timer query functions.\n");
+        return true;
+    }
+    
+    for (int i = 0; i < PROFILER_GPU_QUERIES; i++)
+    {
+        m_gen_queries(1, &m_gpu_queries[i].id);
+        m_gpu_queries[i].pending = false;
+    }
+    
+    // Clear the disjoint flag that may be set since context creation
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    
+    m_gpu_supported = true;
+    
+    return true;
+}
+
+double Profiler::getTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+}
+
+void Profiler::beginFrame()
+{
+    readGPUQueries();
+    
+    float* frame = m_history[m_frame % PROFILER_HISTORY];
+    
+    for (int i = 0; i < PS_COUNT; i++)
+    {
+        frame[i] = 0.0f;
+    }
+    
+    // GPU time is unknown until the query result is read
+    frame[PS_GPU] = -1.0f;
+    
+    m_in_frame = true;
+    m_start[PS_FRAME] = getTime();
+}
+
+void Profiler::endFrame()
+{
+    if (!m_in_frame)
+        return;
+        
+    stopSection(PS_FRAME);
+    
+    m_in_frame = false;
+    m_frame++;
+    m_frames_count = std::min(m_frames_count + 1, 
+                              (unsigned int)PROFILER_HISTORY);
+}
+
+// Time of the section in the last finished frame, in milliseconds
+float Profiler::getLastFrameTime(ProfilerSection section)
+{
+    if (m_frames_count == 0)
+        return 0.0f;
+    
+    return m_history[(m_frame - 1) % PROFILER_HISTORY][section];
+}
+
+void Profiler::cancelFrame()
+{
+    m_in_frame = false;
+}
+
+void Profiler::startSection(ProfilerSection section)
+{
+    if (!m_in_frame)
+        return;
+        
+    m_start[section] = getTime();
+}
+
+void Profiler::stopSection(ProfilerSection section)
+{
+    if (!m_in_frame)
+        return;
+        
+    // Sections can be entered more than once per frame, e.g. for each text
+    float time = (float)(getTime() - m_start[section]);
+    m_history[m_frame % PROFILER_HISTORY][section] += time;
+}
+
+void Profiler::beginGPUTimer()
+{
+    m_gpu_current = NULL;
+    
+    if (!m_gpu_supported || !m_in_frame)
+        return;
+        
+    for (int i = 0; i < PROFILER_GPU_QUERIES; i++)
+    {
+        if (!m_gpu_queries[i].pending)
+        {
+            m_gpu_current = &m_gpu_queries[i];
+            break;
+        }
+    }
+    
+    // All queries are still in flight, so this frame is not measured
+    if (m_gpu_current == NULL)
+        return;
+        
+    m_gpu_current->frame = m_frame;
+    m_begin_query(GL_TIME_ELAPSED_EXT, m_gpu_current->id);
+}
+
+void Profiler::endGPUTimer()
+{
+    if (m_gpu_current == NULL)
+        return;
+        
+    m_end_query(GL_TIME_ELAPSED_EXT);
+    m_gpu_current->pending = true;
+    m_gpu_current = NULL;
+}
+
+void Profiler::readGPUQueries()
+{
+    if (!m_gpu_supported)
+        return;
+        
+    // Results are undefined if GPU was interrupted, e.g. by power saving
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    
+    for (int i = 0; i < PROFILER_GPU_QUERIES; i++)
+    {
+        ProfilerGPUQuery& query = m_gpu_queries[i];
+        
+        if (!query.pending)
+            continue;
+            
+        GLuint available = 0;
+        m_get_query_objectuiv(query.id, GL_QUERY_RESULT_AVAILABLE_EXT, 
+                              &available);
+        
+        if (!available && !disjoint)
+            continue;
+            
+        query.pending = false;
+            
+        if (disjoint || m_frame - query.frame >= PROFILER_HISTORY)
+            continue;
+        
+        GLuint64 time_ns = 0;
+        m_get_query_objectui64v(query.id, GL_QUERY_RESULT_EXT, &time_ns);
+        
+        float* frame = m_history[query.frame % PROFILER_HISTORY];
+        frame[PS_GPU] = (float)time_ns / 1000000.0f;
+    }
+}
+
+void Profiler::getPercentiles(int section, float* p50, float* p95, 
+                              float* p99)
+{
+    float values[PROFILER_HISTORY];
+    unsigned int count = 0;
+    
+    for (unsigned int i = 0; i < m_frames_count; i++)
+    {
+        float value = m_history[(m_frame - 1 - i) % PROFILER_HISTORY][section];
+        
+        if (value < 0.0f)
+            continue;
+            
+        values[count++] = value;
+    }
+    
+    if (count == 0)
+    {
+        *p50 = -1.0f;
+        *p95 = -1.0f;
+        *p99 = -1.0f;
+        return;
+    }
+    
+    float* results[3] = {p50, p95, p99};
+    const float percents[3] = {0.50f, 0.95f, 0.99f};
+    
+    for (int i = 0; i < 3; i++)
+    {
+        unsigned int n = std::min((unsigned int)(percents[i] * count), 
+                                  count - 1);
+        std::nth_element(values, values + n, values + count);
+        *results[i] = values[n];
+    }
+}
+
+void Profiler::drawOverlay()
+{
+    if (!m_overlay_visible)
+        return;
+        
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    int size = std::max((int)device->getWindowHeight() / 40, 8);
+    int line_height = size * 5 / 4;
+    
+    FontManager* font_manager = FontManager::getFontManager();
+    font_manager->changeFont("FreeSans.ttf");
+    
+    GLfloat color[4] = {1.0f, 1.0f, 0.0f, 1.0f};
+    int pos_x = size / 2;
+    int pos_y = line_height;
+    
+    char line[128];
+    snprintf(line, sizeof(line), "last %u frames (ms): p50 / p95 / p99",
+             m_frames_count);
+    font_manager->drawText(line, pos_x, pos_y, size, color);
+    
+    for (int i = 0; i < PS_COUNT; i++)
+    {
+        float p50, p95, p99;
+        getPercentiles(i, &p50, &p95, &p99);
+        
+        pos_y += line_height;
+        
+        if (p50 < 0.0f)
+        {
+            snprintf(line, sizeof(line), "%s: n/a", g_section_names[i]);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%s: %.2f / %.2f / %.2f", 
+                     g_section_names[i], p50, p95, p99);
+        }
+        
+        font_manager->drawText(line, pos_x, pos_y, size, color);
+    }
+}
+
+bool Profiler::exportToFile(std::string path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    
+    if (file == NULL)
+    {
+        printf("Error: Couldn't open profiler output file %s.\n", 
+               path.c_str());
+        return false;
+    }
+    
+    fprintf(file, "index");
+    
+    for (int i = 0; i < PS_COUNT; i++)
+    {
+        fprintf(file, ",%s", g_section_names[i]);
+    }
+    
+    fprintf(file, "\n");
+    
+    for (unsigned int i = 0; i < m_frames_count; i++)
+    {
+        unsigned int frame_id = m_frame - m_frames_count + i;
+        float* frame = m_history[frame_id % PROFILER_HISTORY];
+        
+        fprintf(file, "%u", frame_id);
+        
+        for (int j = 0; j < PS_COUNT; j++)
+        {
+            fprintf(file, ",%.3f", frame[j]);
+        }
+        
+        fprintf(file, "\n");
+    }
+    
+    fprintf(file, "\nsection,p50,p95,p99\n");
+    
+    for (int i = 0; i < PS_COUNT; i++)
+    {
+        float p50, p95, p99;
+        getPercentiles(i, &p50, &p95, &p99);
+        
+        fprintf(file, "%s,%.3f,%.3f,%.3f\n", g_section_names[i], p50, p95, 
+                p99);
+    }
+    
+    fclose(file);
+    
+    printf("Profiler data saved to %s.\n", path.c_str());
+    
+    return true;
+}
+
+const char* Profiler::getSectionName(int section)
+{
+    if (section < 0 || section >= PS_COUNT)
+        return "";
+        
+    return g_section_names[section];
+}
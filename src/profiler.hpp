@@ -0,0 +1,125 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+#include <string>
+
+#define PROFILER_HISTORY 240
+#define PROFILER_GPU_QUERIES 4
+
+enum ProfilerSection
+{
+    PS_FRAME,
+    PS_EVENTS,
+    PS_JOBS,
+    PS_SCENE_UPDATE,
+    PS_EXTRACTION,
+    PS_DRAW_STATIC,
+    PS_DRAW_TEXT,
+    PS_DRAW_BUTTONS,
+    PS_DRAW_PROGRESS,
+    PS_DRAW_FLUSH,
+    PS_SWAP,
+    PS_GPU,
+    PS_COUNT
+};
+
+struct ProfilerGPUQuery
+{
+    GLuint id;
+    unsigned int frame;
+    bool pending;
+};
+
+// Keeps times of the last PROFILER_HISTORY frames in a ring buffer. Times
+// are stored in milliseconds. GPU time is measured with timer queries and
+// is written to the frame in which the query was issued when the result
+// becomes available, which is usually a few frames later.
+class Profiler
+{
+private:
+    float m_history[PROFILER_HISTORY][PS_COUNT];
+    double m_start[PS_COUNT];
+    unsigned int m_frame;
+    unsigned int m_frames_count;
+    bool m_in_frame;
+    bool m_overlay_visible;
+    bool m_gpu_supported;
+    ProfilerGPUQuery m_gpu_queries[PROFILER_GPU_QUERIES];
+    ProfilerGPUQuery* m_gpu_current;
+    std::string m_export_path;
+
+    PFNGLGENQUERIESEXTPROC m_gen_queries;
+    PFNGLDELETEQUERIESEXTPROC m_delete_queries;
+    PFNGLBEGINQUERYEXTPROC m_begin_query;
+    PFNGLENDQUERYEXTPROC m_end_query;
+    PFNGLGETQUERYOBJECTUIVEXTPROC m_get_query_objectuiv;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC m_get_query_objectui64v;
+
+    static Profiler* m_profiler;
+
+    double getTime();
+    void readGPUQueries();
+    void getPercentiles(int section, float* p50, float* p95, float* p99);
+
+public:
+    Profiler();
+    ~Profiler();
+
+    bool init();
+    void beginFrame();
+    void endFrame();
+    void cancelFrame();
+    void startSection(ProfilerSection section);
+    void stopSection(ProfilerSection section);
+    void beginGPUTimer();
+    void endGPUTimer();
+    void drawOverlay();
+    bool exportToFile(std::string path);
+    void setExportPath(std::string path) {m_export_path = path;}
+    std::string getExportPath() {return m_export_path;}
+    void setOverlayVisible(bool visible) {m_overlay_visible = visible;}
+    bool isOverlayVisible() {return m_overlay_visible;}
+    float getLastFrameTime(ProfilerSection section);
+
+    static const char* getSectionName(int section);
+    static Profiler* getProfiler() {return m_profiler;}
+};
+
+class ProfilerScope
+{
+private:
+    ProfilerSection m_section;
+
+public:
+    ProfilerScope(ProfilerSection section)
+    {
+        m_section = section;
+        Profiler::getProfiler()->startSection(section);
+    }
+
+    ~ProfilerScope()
+    {
+        Profiler::getProfiler()->stopSection(m_section);
+    }
+};
+
+#endif
@@ -0,0 +1,244 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "file_manager.hpp"
+#include "program_cache.hpp"
+
+#include <EGL/egl.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+ProgramCache* ProgramCache::m_program_cache = NULL;
+
+ProgramCache::ProgramCache()
+{
+    m_program_cache = this;
+    m_driver_hash = 0;
+    m_supported = false;
+    m_retrievable_hint = false;
+    m_get_program_binary = NULL;
+    m_program_binary = NULL;
+}
+
+ProgramCache::~ProgramCache()
+{
+    m_program_cache = NULL;
+}
+
+bool ProgramCache::init()
+{
+    GLint major_version = 2;
+    glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+    glGetError();
+    
+    GLint formats_count = 0;
+    
+    if (major_version >= 3)
+    {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_count);
+        
+        m_get_program_binary = glGetProgramBinary;
+        m_program_binary = glProgramBinary;
+        m_retrievable_hint = true;
+    }
+    else
+    {
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+        
+        if (extensions != NULL && 
+            strstr(extensions, "GL_OES_get_program_binary") != NULL)
+        {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats_count);
+            
+            m_get_program_binary = (PFNGLGETPROGRAMBINARYOESPROC)
+                                    eglGetProcAddress("glGetProgramBinaryOES");
+            m_program_binary = (PFNGLPROGRAMBINARYOESPROC)
+                                    eglGetProcAddress("glProgramBinaryOES");
+        }
+    }
+    
+    if (formats_count <= 0 || m_get_program_binary == NULL || 
+        m_program_binary == NULL)
+    {
+        printf("Warning: Program binaries are not supported.\n");
+        return true;
+    }
+    
+    FileManager* file_manager = FileManager::getFileManager();
+    m_cache_dir = file_manager->getCacheDir();
+    
+    if (m_cache_dir.empty())
+        return true;
+        
+    m_cache_dir += "/programs";
+    
+    if (!file_manager->createDirectory(m_cache_dir))
+    {
+        printf("Warning: Couldn't create program cache directory.\n");
+        return true;
+    }
+    
+    const GLenum names[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    m_driver_hash = hash("", 0);
+    
+    for (int i = 0; i < 3; i++)
+    {
+        const char* value = (const char*)glGetString(names[i]);
+        
+        if (value != NULL)
+        {
+            m_driver_hash = hash(value, strlen(value), m_driver_hash);
+        }
+    }
+    
+    m_supported = true;
+    
+    return true;
+}
+
+// FNV-1a, seed allows to hash data that is split into a few parts
+uint64_t ProgramCache::hash(const char* data, int length, uint64_t seed)
+{
+    uint64_t result = seed;
+    
+    for (int i = 0; i < length; i++)
+    {
+        result ^= (unsigned char)data[i];
+        result *= 0x100000001b3ULL;
+    }
+    
+    return result;
+}
+
+std::string ProgramCache::getFilePath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)key);
+    
+    return m_cache_dir + name;
+}
+
+// Returns linked program or 0 if there is no valid binary for this driver
+GLuint ProgramCache::loadProgram(uint64_t key)
+{
+    if (!m_supported)
+        return 0;
+        
+    std::ifstream is(getFilePath(key).c_str(), std::ios::binary);
+    
+    if (!is.good())
+        return 0;
+        
+    ProgramCacheHeader header;
+    is.read((char*)&header, sizeof(header));
+    
+    if (!is.good() || header.magic != PROGRAM_CACHE_MAGIC || 
+        header.version != PROGRAM_CACHE_VERSION || 
+        header.driver_hash != m_driver_hash || header.key != key || 
+        header.length == 0)
+        return 0;
+
+    // The length comes from the file, so it's checked against the real file
+    // size before anything is allocated. A corrupted or truncated file is
+    // treated as a cache miss.
+    is.seekg(0, std::ios::end);
+    std::streamoff file_size = is.tellg();
+
+    if (!is.good() ||
+        file_size != (std::streamoff)(sizeof(header) + header.length))
+        return 0;
+
+    is.seekg(sizeof(header), std::ios::beg);
+
+    std::vector<char> binary(header.length);
+    is.read(&binary[0], header.length);
+    
+    if (!is.good())
+        return 0;
+        
+    GLuint program = glCreateProgram();
+    m_program_binary(program, header.format, &binary[0], header.length);
+    
+    // Driver may still reject the binary, e.g. after an update that didn't
+    // change the version string
+    GLint program_ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &program_ok);
+    glGetError();
+    
+    if (!program_ok)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    
+    return program;
+}
+
+// Must be called before the program is linked
+void ProgramCache::prepareProgram(GLuint program)
+{
+    if (!m_supported || !m_retrievable_hint)
+        return;
+        
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, 
+                        GL_TRUE);
+}
+
+void ProgramCache::saveProgram(uint64_t key, GLuint program)
+{
+    if (!m_supported || program == 0)
+        return;
+        
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    
+    if (length <= 0)
+        return;
+        
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    m_get_program_binary(program, length, &length, &format, &binary[0]);
+    
+    if (glGetError() != GL_NO_ERROR || length <= 0)
+        return;
+        
+    ProgramCacheHeader header;
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.driver_hash = m_driver_hash;
+    header.key = key;
+    header.format = format;
+    header.length = length;
+    
+    // Written to a temporary file first, so that a crash doesn't leave a 
+    // truncated binary
+    std::string path = getFilePath(key);
+    std::string tmp_path = path + ".tmp";
+    
+    std::ofstream os(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+    os.write((const char*)&header, sizeof(header));
+    os.write(&binary[0], length);
+    os.close();
+    
+    if (!os.good() || rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        printf("Warning: Couldn't save program binary %s\n", path.c_str());
+        remove(tmp_path.c_str());
+    }
+}
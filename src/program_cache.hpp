@@ -0,0 +1,76 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+#include <cstdint>
+#include <string>
+
+#define PROGRAM_CACHE_MAGIC 0x50434b53
+#define PROGRAM_CACHE_VERSION 1
+
+struct ProgramCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t driver_hash;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+// Linked programs are stored as driver specific binaries in the cache 
+// directory, one file per program. Files are named by the hash of program
+// sources, and the header contains the hash of the driver strings, so a
+// binary from another driver version is ignored and overwritten.
+class ProgramCache
+{
+private:
+    std::string m_cache_dir;
+    uint64_t m_driver_hash;
+    bool m_supported;
+    bool m_retrievable_hint;
+    
+    PFNGLGETPROGRAMBINARYOESPROC m_get_program_binary;
+    PFNGLPROGRAMBINARYOESPROC m_program_binary;
+    
+    static ProgramCache* m_program_cache;
+    
+    std::string getFilePath(uint64_t key);
+
+public:
+    ProgramCache();
+    ~ProgramCache();
+    
+    bool init();
+    GLuint loadProgram(uint64_t key);
+    void prepareProgram(GLuint program);
+    void saveProgram(uint64_t key, GLuint program);
+    bool isSupported() {return m_supported;}
+    
+    static uint64_t hash(const char* data, int length, 
+                         uint64_t seed = 0xcbf29ce484222325ULL);
+    static uint64_t hash(const std::string& text, 
+                         uint64_t seed = 0xcbf29ce484222325ULL)
+                        {return hash(text.c_str(), text.size(), seed);}
+    static ProgramCache* getProgramCache() {return m_program_cache;}
+};
+
+#endif
@@ -14,7 +14,11 @@
 //    You should have received a copy of the GNU General Public License
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include "draw_utils.hpp"
+#include "gl_state.hpp"
 #include "progress_bar.hpp"
+#include "scene_manager.hpp"
+#include "telemetry.hpp"
 
 bool ProgressBarProgram::create()
 {
@@ -46,6 +50,7 @@ ProgressBar::ProgressBar()
 
 ProgressBar::~ProgressBar()
 {
+    GLState::getGLState()->onBufferDeleted(m_vbo);
     glDeleteBuffers(1, &m_vbo);
     
     delete m_program;
@@ -67,7 +72,7 @@ bool ProgressBar::init(float pos_x, float pos_y, float width, float height)
     GLfloat box[4][2] = {{x, -y}, {x + w, -y}, {x, -y - h}, {x + w, -y - h}};
 
     glGenBuffers(1, &m_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    GLState::getGLState()->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(box), box, GL_STATIC_DRAW);
 
     return true;
@@ -75,18 +80,28 @@ bool ProgressBar::init(float pos_x, float pos_y, float width, float height)
 
 void ProgressBar::draw(GLfloat color[4])
 {
-    glUseProgram(m_program->getProgram());
+    DrawUtils::getDrawUtils()->flush();
     
-    glEnableVertexAttribArray(m_program->m_coord);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    GLState* gl_state = GLState::getGLState();
+    gl_state->bindVertexArray(0);
+    gl_state->useProgram(m_program->getProgram());
+    gl_state->setAttribArrays(1 << m_program->m_coord);
+    gl_state->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
     glVertexAttribPointer(m_program->m_coord, 2, GL_FLOAT, GL_FALSE, 0, 0);
 
-    glUniform4fv(m_program->m_color, 1, color);
-    glUniform1f(m_program->m_progress, std::min(m_value, 1.0f));
+    m_program->m_color.set(color);
+    m_program->m_progress.set(std::min(m_value, 1.0f));
     
+    gl_state->setBlend(false);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    Telemetry::getTelemetry()->addDrawCall();
+}
+
+void ProgressBar::setValue(float value)
+{
+    if (value == m_value)
+        return;
     
-    glDisableVertexAttribArray(m_program->m_coord);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glUseProgram(0);
+    m_value = value;
+    SceneManager::getSceneManager()->requestRedraw();
 }
@@ -23,8 +23,8 @@ class ProgressBarProgram : public Shader
 {
 public:
     GLint m_coord;
-    GLint m_progress;
-    GLint m_color;
+    UniformFloat m_progress;
+    UniformVec4 m_color;
 
     bool create();
 };
@@ -43,7 +43,7 @@ public:
     bool init(float pos_x, float pos_y, float width, float height);
     void draw(GLfloat color[4]);
     float getValue() {return m_value;}
-    void setValue(float value) {m_value = value;}
+    void setValue(float value);
 };
 
 #endif
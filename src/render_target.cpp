@@ -0,0 +1,190 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gl_state.hpp"
+#include "image_loader.hpp"
+#include "render_target.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+RenderTarget::RenderTarget()
+{
+    m_framebuffer = 0;
+    m_texture = 0;
+    m_depth_buffer = 0;
+    m_width = 0;
+    m_height = 0;
+}
+
+RenderTarget::~RenderTarget()
+{
+    destroy();
+}
+
+void RenderTarget::destroy()
+{
+    GLState* gl_state = GLState::getGLState();
+    
+    if (m_framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        
+        if (gl_state != NULL)
+        {
+            gl_state->onFramebufferDeleted(m_framebuffer);
+        }
+    }
+    
+    if (m_texture != 0)
+    {
+        glDeleteTextures(1, &m_texture);
+        
+        if (gl_state != NULL)
+        {
+            gl_state->onTextureDeleted(m_texture);
+        }
+    }
+    
+    if (m_depth_buffer != 0)
+    {
+        glDeleteRenderbuffers(1, &m_depth_buffer);
+    }
+    
+    m_framebuffer = 0;
+    m_texture = 0;
+    m_depth_buffer = 0;
+}
+
+// Leaves the new framebuffer bound. It can be called before GLState is
+// created, e.g. by headless device, so GL is called directly and the shadow
+// state is invalidated afterwards.
+bool RenderTarget::init(int width, int height, bool with_depth)
+{
+    destroy();
+    
+    m_width = width;
+    m_height = height;
+    
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, 
+                 GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 
+                           GL_TEXTURE_2D, m_texture, 0);
+    
+    if (with_depth)
+    {
+        glGenRenderbuffers(1, &m_depth_buffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_depth_buffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, 
+                              height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, 
+                                  GL_RENDERBUFFER, m_depth_buffer);
+    }
+    
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    
+    GLState* gl_state = GLState::getGLState();
+    
+    if (gl_state != NULL)
+    {
+        gl_state->invalidate();
+    }
+    
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        printf("Error: Framebuffer is not complete (0x%x).\n", status);
+        destroy();
+        return false;
+    }
+    
+    return true;
+}
+
+void RenderTarget::bind()
+{
+    GLState* gl_state = GLState::getGLState();
+    gl_state->bindFramebuffer(m_framebuffer);
+    gl_state->viewport(0, 0, m_width, m_height);
+}
+
+void RenderTarget::unbind()
+{
+    GLState* gl_state = GLState::getGLState();
+    gl_state->bindDefaultFramebuffer();
+}
+
+// Returns RGBA pixels with the first row at the top
+bool RenderTarget::readPixels(std::vector<unsigned char>& pixels)
+{
+    if (m_framebuffer == 0)
+        return false;
+    
+    GLState* gl_state = GLState::getGLState();
+    gl_state->bindFramebuffer(m_framebuffer);
+    
+    int pitch = m_width * 4;
+    pixels.resize(pitch * m_height);
+    
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, 
+                 &pixels[0]);
+                 
+    gl_state->bindDefaultFramebuffer();
+    
+    std::vector<unsigned char> row(pitch);
+    
+    for (int i = 0; i < m_height / 2; i++)
+    {
+        unsigned char* top = &pixels[i * pitch];
+        unsigned char* bottom = &pixels[(m_height - 1 - i) * pitch];
+        
+        memcpy(&row[0], top, pitch);
+        memcpy(top, bottom, pitch);
+        memcpy(bottom, &row[0], pitch);
+    }
+    
+    return glGetError() == GL_NO_ERROR;
+}
+
+bool RenderTarget::saveToPNG(std::string path)
+{
+    std::vector<unsigned char> pixels;
+    bool success = readPixels(pixels);
+    
+    if (!success)
+    {
+        printf("Error: Couldn't read pixels from framebuffer.\n");
+        return false;
+    }
+    
+    Image image;
+    image.width = m_width;
+    image.height = m_height;
+    image.channels = 4;
+    image.data_length = pixels.size();
+    image.data = &pixels[0];
+    
+    return ImageLoader::saveImage(path, &image);
+}
@@ -0,0 +1,53 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef RENDER_TARGET_HPP
+#define RENDER_TARGET_HPP
+
+#include <GLES3/gl3.h>
+
+#include <string>
+#include <vector>
+
+// Framebuffer object with a color texture and an optional depth buffer
+class RenderTarget
+{
+private:
+    GLuint m_framebuffer;
+    GLuint m_texture;
+    GLuint m_depth_buffer;
+    int m_width;
+    int m_height;
+    
+    void destroy();
+
+public:
+    RenderTarget();
+    ~RenderTarget();
+    
+    bool init(int width, int height, bool with_depth);
+    void bind();
+    void unbind();
+    bool readPixels(std::vector<unsigned char>& pixels);
+    bool saveToPNG(std::string path);
+    
+    GLuint getFramebuffer() {return m_framebuffer;}
+    GLuint getTexture() {return m_texture;}
+    int getWidth() {return m_width;}
+    int getHeight() {return m_height;}
+};
+
+#endif
@@ -19,9 +19,15 @@
 #include "draw_utils.hpp"
 #include "file_manager.hpp"
 #include "font_manager.hpp"
+#include "job_queue.hpp"
+#include "layer_cache.hpp"
+#include "layout.hpp"
+#include "profiler.hpp"
 #include "progress_bar.hpp"
 #include "scene_main.hpp"
 #include "scene_manager.hpp"
+#include "static_mesh.hpp"
+#include "text_mesh.hpp"
 #include "texture_manager.hpp"
 
 #include <cmath>
@@ -55,16 +61,29 @@ SceneMain::SceneMain()
     
     m_gui_scale = (float)window_h / 600.0f;
     m_text_height = 24 * m_gui_scale;
-    m_btn_width = 128 * m_gui_scale;
+    int btn_width = 128 * m_gui_scale;
     
     m_button_install = new Button();
-    m_button_install->init("install", "Install", 0, 0, m_btn_width);
+    m_button_install->init("install", "Install", 0, 0, btn_width);
 
     m_button_close = new Button();
-    m_button_close->init("close", "Close", 0, 0, m_btn_width);
+    m_button_close->init("close", "Close", 0, 0, btn_width);
 
     m_progress_bar = new ProgressBar();
     m_progress_bar->init(0.0f, 0.925f, 1.0f, 0.05f);
+    
+    m_title_mesh = new TextMesh();
+    m_title_mesh->setText(m_extract_title, "SigmarOne.otf", 
+                          m_text_height * 1.5f);
+    
+    m_text_mesh = new TextMesh();
+    m_text_mesh->setText("", "FreeSans.ttf", m_text_height);
+    
+    m_text2_mesh = new TextMesh();
+    m_text2_mesh->setText("", "FreeSans.ttf", m_text_height);
+    
+    m_static_mesh = new StaticMesh();
+    m_background_layer = new LayerCache();
 
     TextureManager* texture_manager = TextureManager::getTextureManager();
     m_background = texture_manager->getTexture("background.jpg");
@@ -89,6 +108,9 @@ SceneMain::SceneMain()
     {
         setState(ES_NOT_INSTALLED);
     }
+    
+    m_layout = new Layout();
+    initLayout();
 }
 
 SceneMain::~SceneMain()
@@ -96,6 +118,12 @@ SceneMain::~SceneMain()
     delete m_progress_bar;
     delete m_button_install;
     delete m_button_close;
+    delete m_title_mesh;
+    delete m_text_mesh;
+    delete m_text2_mesh;
+    delete m_static_mesh;
+    delete m_background_layer;
+    delete m_layout;
 }
 
 void SceneMain::readSettings()
@@ -170,6 +198,7 @@ void SceneMain::setState(ExtractState state)
         m_text2 = "";
         m_progress_bar->setValue(0.0f);
         m_extract_progress = 0;
+        JobQueue::getJobQueue()->addJob([this]() {return extractNextAsset();});
         break;
     case ES_INSTALLED:
         m_button_install->setText("Reinstall");
@@ -189,111 +218,234 @@ void SceneMain::setState(ExtractState state)
         break;
     }
     
+    m_text_mesh->setText(m_text);
+    m_text2_mesh->setText(m_text2);
+    
     m_extract_state = state;
+    
+    SceneManager::getSceneManager()->requestRedraw();
 }
 
-void SceneMain::update(float dt)
+// Files are extracted in a job, so that small files are extracted a few at
+// once and the frame rate doesn't drop with big ones
+bool SceneMain::extractNextAsset()
 {
+    if (m_extract_state != ES_INSTALLING ||
+        m_extract_progress >= m_extract_assets.size())
+        return true;
+    
+    ProfilerScope scope(PS_EXTRACTION);
+    
     FileManager* file_manager = FileManager::getFileManager();
+    std::string file_path = m_extract_assets[m_extract_progress];
     
-    if (m_extract_state == ES_INSTALLING &&
-        m_extract_progress < m_extract_assets.size())
-    {
-        std::string file_path = m_extract_assets[m_extract_progress];
-        
-        bool success = file_manager->extractFromAssets(file_path, "extract/", 
-                                                       m_extract_dest);
+    bool success = file_manager->extractFromAssets(file_path, "extract/", 
+                                                   m_extract_dest);
 
-        if (!success)
-        {
-            setState(ES_INSTALLATION_FAILED);
-        }
-        
-        m_extract_progress++;
+    if (!success)
+    {
+        setState(ES_INSTALLATION_FAILED);
+    }
+    
+    m_extract_progress++;
 
-        float value = (float)m_extract_progress / m_extract_assets.size();
-        m_progress_bar->setValue(value);
+    float value = (float)m_extract_progress / m_extract_assets.size();
+    m_progress_bar->setValue(value);
 
-        if (m_extract_progress == m_extract_assets.size())
-        {
-            file_manager->touchFile(m_extract_dest + m_extract_marker);
-            setState(ES_INSTALLED);
-        }
+    if (m_extract_progress == m_extract_assets.size())
+    {
+        file_manager->touchFile(m_extract_dest + m_extract_marker);
+        setState(ES_INSTALLED);
     }
+    
+    return m_extract_state != ES_INSTALLING;
+}
 
+void SceneMain::update(float dt)
+{
     drawScene();
 }
 
-void SceneMain::drawScene()
+// Sizes and offsets are in gui units, i.e. pixels at 600px window height
+void SceneMain::initLayout()
 {
-    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
-    FontManager* font_manager = FontManager::getFontManager();
-
-    GLfloat black[4] = {0, 0, 0, 1};
-    GLfloat blue[4] = {0.15f, 0.65f, 0.8f, 1.0f};
+    TextureManager* texture_manager = TextureManager::getTextureManager();
+    Texture* button_tex = texture_manager->getTexture("button.png");
     
-    Device* device = DeviceManager::getDeviceManager()->getDevice();
-    int window_w = device->getWindowWidth();
-    int window_h = device->getWindowHeight();
+    m_layout->init(600.0f);
+    
+    m_node_background = m_layout->addNode();
+    m_layout->setSize(m_node_background, 0, 0, 1.0f, 1.0f);
+    
+    m_node_logo = m_layout->addNode();
+    m_layout->setAnchor(m_node_logo, 0.5f, 0.0f, 0.5f, 0.0f);
+    m_layout->setSize(m_node_logo, 256, 0);
+    m_layout->setAspect(m_node_logo, m_logo->width, m_logo->height);
+    
+    m_node_text_bg = m_layout->addNode();
+    m_layout->setOffset(m_node_text_bg, 20, 260);
+    m_layout->setSize(m_node_text_bg, -40, -370, 1.0f, 0.93f);
+    
+    m_node_screenshot = m_layout->addNode();
+    m_layout->setAnchor(m_node_screenshot, 1.0f, 0.0f, 1.0f, 0.0f);
+    m_layout->setOffset(m_node_screenshot, -40, 330);
+    m_layout->setSize(m_node_screenshot, 100, 0);
+    m_layout->setAspect(m_node_screenshot, m_screenshot->width, 
+                        m_screenshot->height);
+    
+    // Text is drawn from the baseline, so only the position is used
+    m_node_title = m_layout->addNode();
+    m_layout->setAnchor(m_node_title, 0.5f, 0.0f, 0.5f, 0.0f);
+    m_layout->setOffset(m_node_title, 0, 300);
+    m_layout->setContentSize(m_node_title, m_title_mesh->getWidth(), 0);
+    
+    m_node_text = m_layout->addNode(m_node_text_bg);
+    m_layout->setOffset(m_node_text, 10, 90);
+    
+    m_node_text2 = m_layout->addNode(m_node_text_bg);
+    m_layout->setOffset(m_node_text2, 10, 140);
+    
+    m_node_install = m_layout->addNode();
+    m_layout->setAnchor(m_node_install, 0.5f, 0.93f, 0.5f, 0.0f);
+    m_layout->setOffset(m_node_install, -100, -70);
+    m_layout->setSize(m_node_install, 128, 0);
+    m_layout->setAspect(m_node_install, button_tex->width, 
+                        button_tex->height);
+    
+    m_node_close = m_layout->addNode();
+    m_layout->setAnchor(m_node_close, 0.5f, 0.93f, 0.5f, 0.0f);
+    m_layout->setOffset(m_node_close, 100, -70);
+    m_layout->setSize(m_node_close, 128, 0);
+    m_layout->setAspect(m_node_close, button_tex->width, button_tex->height);
+}
 
-    draw_utils->drawTexture2D(m_background, 0, 0, window_w, window_h);
+void SceneMain::setGuiScale(float scale)
+{
+    m_gui_scale = scale;
+    m_text_height = 24 * m_gui_scale;
     
-    int logo_w = 256 * m_gui_scale;
-    int logo_h = logo_w * m_logo->height / m_logo->width;
-    int logo_x = (window_w - logo_w) / 2;
-    int logo_y = 0 * m_gui_scale;
+    m_title_mesh->setText(m_extract_title, "SigmarOne.otf", 
+                          m_text_height * 1.5f);
+    m_text_mesh->setText(m_text, "FreeSans.ttf", m_text_height);
+    m_text2_mesh->setText(m_text2, "FreeSans.ttf", m_text_height);
     
-    draw_utils->drawTexture2D(m_logo, logo_x, logo_y, logo_w, logo_h);
+    m_layout->setContentSize(m_node_title, m_title_mesh->getWidth(), 0);
+}
 
-    int text_bg_w = window_w - 40 * m_gui_scale;
-    int text_bg_h = window_h * 0.93 - 370 * m_gui_scale;
-    int text_bg_x = 20 * m_gui_scale;
-    int text_bg_y = 260 * m_gui_scale;
+// The layout is computed only on window resize, so that drawing and 
+// hit-testing just read the cached rectangles
+void SceneMain::updateLayout()
+{
+    // Glyphs that are still rendered in background have placeholder metrics,
+    // so the title width can change when the font atlas is updated. The 
+    // width is cached in the text mesh, so it's a no-op most of the time.
+    m_layout->setContentSize(m_node_title, m_title_mesh->getWidth(), 0);
+    
+    if (!m_layout->isOutdated())
+        return;
+    
+    m_layout->update();
+    
+    // Text size depends on the scale, so the title width is known only 
+    // after the first pass
+    if (m_layout->getScale() != m_gui_scale)
+    {
+        setGuiScale(m_layout->getScale());
+        m_layout->update();
+    }
+    
+    const LayoutRect& install = m_layout->getRect(m_node_install);
+    m_button_install->setWidth(install.width);
+    m_button_install->setPosX(install.x);
+    m_button_install->setPosY(install.y);
     
-    draw_utils->drawTexture2D(m_text_bg, text_bg_x, text_bg_y, text_bg_w, text_bg_h);
+    const LayoutRect& close = m_layout->getRect(m_node_close);
+    m_button_close->setWidth(close.width);
+    m_button_close->setPosX(close.x);
+    m_button_close->setPosY(close.y);
+}
+
+void SceneMain::drawBackground()
+{
+    GLfloat black[4] = {0, 0, 0, 1};
+
+    // Quads that depend only on the window size are kept in a static mesh
+    if (m_static_mesh->isOutdated())
+    {
+        const LayoutRect& bg = m_layout->getRect(m_node_background);
+        const LayoutRect& logo = m_layout->getRect(m_node_logo);
+        const LayoutRect& text_bg = m_layout->getRect(m_node_text_bg);
+        const LayoutRect& sshot = m_layout->getRect(m_node_screenshot);
+        
+        m_static_mesh->begin();
+        m_static_mesh->addTexture(m_background, bg.x, bg.y, bg.width, 
+                                  bg.height);
+        m_static_mesh->addTexture(m_logo, logo.x, logo.y, logo.width, 
+                                  logo.height);
+        m_static_mesh->addTexture(m_text_bg, text_bg.x, text_bg.y, 
+                                  text_bg.width, text_bg.height);
+        m_static_mesh->addTexture(m_screenshot, sshot.x, sshot.y, sshot.width, 
+                                  sshot.height);
+        m_static_mesh->end();
+    }
     
-    int sshot_w = 100 * m_gui_scale;
-    int sshot_h = sshot_w * m_screenshot->height / m_screenshot->width;
-    int sshot_x = window_w - 40 * m_gui_scale - sshot_w;
-    int sshot_y = 330 * m_gui_scale;
+    m_static_mesh->draw();
     
-    draw_utils->drawTexture2D(m_screenshot, sshot_x, sshot_y, sshot_w, sshot_h);
-           
-    font_manager->changeFont("SigmarOne.otf");
+    const LayoutRect& title = m_layout->getRect(m_node_title);
+    m_title_mesh->draw(title.x, title.y, black);
+}
 
-    int title_h = m_text_height * 1.5f;
-    int title_w = font_manager->getTextWidth(m_extract_title, title_h);
-    int title_x = (window_w - title_w) / 2;
-    int title_y = 300 * m_gui_scale;
+void SceneMain::drawScene()
+{
+    GLfloat black[4] = {0, 0, 0, 1};
+    GLfloat blue[4] = {0.15f, 0.65f, 0.8f, 1.0f};
     
-    font_manager->drawText(m_extract_title, title_x, title_y, title_h, black);
+    updateLayout();
 
-    font_manager->changeFont("FreeSans.ttf");
+    Profiler* profiler = Profiler::getProfiler();
+    profiler->startSection(PS_DRAW_STATIC);
+    
+    // Background, logo, text panel and title are drawn to the layer once, 
+    // and then it's a single opaque quad instead of a few overlapping ones
+    if (m_background_layer->isOutdated() && m_background_layer->begin())
+    {
+        drawBackground();
+        m_background_layer->end();
+    }
+    
+    if (m_background_layer->isReady())
+    {
+        m_background_layer->draw();
+    }
+    else
+    {
+        drawBackground();
+    }
     
-    int text_x = 30 * m_gui_scale;
-    int text_y1 = 350 * m_gui_scale;
-    int text_y2 = 400 * m_gui_scale;
+    profiler->stopSection(PS_DRAW_STATIC);
+    profiler->startSection(PS_DRAW_TEXT);
     
-    font_manager->drawText(m_text, text_x, text_y1, m_text_height, black);
-    font_manager->drawText(m_text2, text_x, text_y2, m_text_height, black);
+    const LayoutRect& text = m_layout->getRect(m_node_text);
+    const LayoutRect& text2 = m_layout->getRect(m_node_text2);
     
-    int btn_center = (window_w - m_btn_width) / 2;
-    int btn_x1 = btn_center - 100 * m_gui_scale;
-    int btn_x2 = btn_center + 100 * m_gui_scale;
-    int btn_y = window_h * 0.93 - 70 * m_gui_scale;
+    m_text_mesh->draw(text.x, text.y, black);
+    m_text2_mesh->draw(text2.x, text2.y, black);
+    
+    profiler->stopSection(PS_DRAW_TEXT);
+    profiler->startSection(PS_DRAW_BUTTONS);
     
-    m_button_install->setPosX(btn_x1);
-    m_button_install->setPosY(btn_y);
     m_button_install->draw();
-
-    m_button_close->setPosX(btn_x2);
-    m_button_close->setPosY(btn_y);
     m_button_close->draw();
     
+    profiler->stopSection(PS_DRAW_BUTTONS);
+    profiler->startSection(PS_DRAW_PROGRESS);
+    
     m_progress_bar->draw(blue);
+    
+    profiler->stopSection(PS_DRAW_PROGRESS);
 }
 
-bool SceneMain::onEvent(Event event)
+bool SceneMain::onEvent(const Event& event)
 {
     Device* device = DeviceManager::getDeviceManager()->getDevice();
     
@@ -301,12 +453,14 @@ bool SceneMain::onEvent(Event event)
     
     if (event.type == ET_MOUSE_EVENT)
     {
-        MouseEvent mouse_event = event.mouse;
+        const MouseEvent& mouse_event = event.mouse;
 
         if (mouse_event.type == ME_LEFT_PRESSED)
         {
-            if (m_button_install->isCursorOverButton(mouse_event.x, 
-                                                     mouse_event.y))
+            updateLayout();
+            
+            if (m_layout->isPointInside(m_node_install, mouse_event.x, 
+                                        mouse_event.y))
             {
                 if (m_extract_state != ES_INSTALLING &&
                     m_extract_state != ES_DEST_DIR_NOT_FOUND)
@@ -314,8 +468,8 @@ bool SceneMain::onEvent(Event event)
                     setState(ES_INSTALLING);
                 }
             }
-            else if (m_button_close->isCursorOverButton(mouse_event.x, 
-                                                        mouse_event.y))
+            else if (m_layout->isPointInside(m_node_close, mouse_event.x, 
+                                             mouse_event.y))
             {
                 if (m_extract_state != ES_INSTALLING)
                 {
@@ -328,7 +482,7 @@ bool SceneMain::onEvent(Event event)
     }
     else if (event.type == ET_KEY_EVENT)
     {
-        KeyEvent key_event = event.key;
+        const KeyEvent& key_event = event.key;
 
         if (key_event.pressed)
         {
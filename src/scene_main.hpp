@@ -33,7 +33,11 @@ enum ExtractState
 };
 
 class Button;
+class LayerCache;
+class Layout;
 class ProgressBar;
+class StaticMesh;
+class TextMesh;
 
 class SceneMain : public Scene
 {
@@ -45,11 +49,25 @@ private:
     Texture* m_logo;
     Texture* m_screenshot;
     Texture* m_text_bg;
+    TextMesh* m_title_mesh;
+    TextMesh* m_text_mesh;
+    TextMesh* m_text2_mesh;
+    StaticMesh* m_static_mesh;
+    LayerCache* m_background_layer;
+    Layout* m_layout;
+    int m_node_background;
+    int m_node_logo;
+    int m_node_text_bg;
+    int m_node_screenshot;
+    int m_node_title;
+    int m_node_text;
+    int m_node_text2;
+    int m_node_install;
+    int m_node_close;
     std::string m_text;
     std::string m_text2;
     float m_gui_scale;
     int m_text_height;
-    int m_btn_width;
     
     std::vector<std::string> m_extract_assets;
     std::string m_extract_dest;
@@ -59,8 +77,13 @@ private:
     std::string m_extract_screenshot;
     std::string m_extract_marker;
     
+    void initLayout();
+    void updateLayout();
+    void setGuiScale(float scale);
     void drawScene();
+    void drawBackground();
     void setState(ExtractState state);
+    bool extractNextAsset();
     void readSettings();
 
 public:
@@ -68,7 +91,7 @@ public:
     ~SceneMain();
     
     void update(float dt);
-    bool onEvent(Event event);
+    bool onEvent(const Event& event);
 };
 
 #endif
@@ -15,8 +15,16 @@
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "device_manager.hpp"
+#include "draw_utils.hpp"
+#include "file_manager.hpp"
+#include "font_manager.hpp"
+#include "gl_state.hpp"
+#include "job_queue.hpp"
+#include "profiler.hpp"
 #include "scene_main.hpp"
 #include "scene_manager.hpp"
+#include "telemetry.hpp"
+#include "texture_manager.hpp"
 
 SceneManager* SceneManager::m_scene_manager = NULL;
 
@@ -43,32 +51,143 @@ bool SceneManager::init()
 bool SceneManager::update(float dt)
 {
     Device* device = DeviceManager::getDeviceManager()->getDevice();
-    bool close = !device->processEvents();
+    FontManager* font_manager = FontManager::getFontManager();
+    
+    // Nothing is drawn until something changes, so the loop sleeps in
+    // processEvents while the screen is static. Glyphs and textures that are
+    // prepared in background don't send any events, so they are checked
+    // periodically.
+    JobQueue* job_queue = JobQueue::getJobQueue();
+    TextureManager* texture_manager = TextureManager::getTextureManager();
+    int timeout_ms = -1;
+    
+    if (device->isRedrawRequested() || job_queue->hasJobs())
+    {
+        timeout_ms = 0;
+    }
+    else if (font_manager->hasPendingGlyphs() || 
+             texture_manager->hasPendingTextures())
+    {
+        timeout_ms = 10;
+    }
+    
+    bool close = false;
+    
+    // Time spent waiting for events is not a part of the frame
+    if (timeout_ms != 0)
+    {
+        close = !device->processEvents(timeout_ms);
+    }
+    
+    Profiler* profiler = Profiler::getProfiler();
+    profiler->beginFrame();
+    
+    if (!close)
+    {
+        ProfilerScope scope(PS_EVENTS);
+        close = !device->processEvents(0);
+    }
     
     if (close)
+    {
+        profiler->cancelFrame();
         return true;
+    }
+    
+    font_manager->update();
+    texture_manager->update();
+    
+    // Jobs that change something on the screen request redraw themselves
+    if (job_queue->hasJobs())
+    {
+        ProfilerScope scope(PS_JOBS);
+        job_queue->run();
+    }
+    
+    if (!device->isRedrawRequested())
+    {
+        profiler->cancelFrame();
+        return false;
+    }
+    
+    // Changes made during the scene update request the next frame
+    device->clearRedrawRequest();
+    
+    profiler->beginGPUTimer();
     
-    glViewport(0, 0, device->getWindowWidth(), device->getWindowHeight());
+    GLState* gl_state = GLState::getGLState();
+    gl_state->viewport(0, 0, device->getWindowWidth(), 
+                       device->getWindowHeight());
     
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    gl_state->clearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+    draw_utils->begin();
+    
     if (m_scene != NULL)
     {
+        ProfilerScope scope(PS_SCENE_UPDATE);
         m_scene->update(dt);
     }
+    
+    profiler->drawOverlay();
+    
+    {
+        ProfilerScope scope(PS_DRAW_FLUSH);
+        draw_utils->flush();
+    }
+    
+    profiler->endGPUTimer();
 
-    device->swapBuffers();
+    {
+        ProfilerScope scope(PS_SWAP);
+        device->swapBuffers();
+    }
+    
+    profiler->endFrame();
+    
+    // Keep the overlay numbers up to date
+    if (profiler->isOverlayVisible())
+    {
+        device->requestRedraw();
+    }
     
     return close;
 }
 
-void SceneManager::onEvent(Event event)
+void SceneManager::requestRedraw()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    device->requestRedraw();
+}
+
+void SceneManager::onEvent(const Event& event)
 {
     SceneManager* scene_manager = SceneManager::getSceneManager();
     Device* device = DeviceManager::getDeviceManager()->getDevice();
     Scene* scene = scene_manager->getScene();
     
+    // Sensors don't change anything on the screen
+    if (event.type != ET_ACCELEROMETER_EVENT && 
+        event.type != ET_GYROSCOPE_EVENT)
+    {
+        device->requestRedraw();
+    }
+    
+    // Time between receiving the event and handling it in the scene
+    if (event.type == ET_MOUSE_EVENT || event.type == ET_KEY_EVENT ||
+        event.type == ET_TOUCH_EVENT)
+    {
+        unsigned long now = device->getMicroTickCount();
+        unsigned long event_time = device->getEventTime();
+        
+        if (event_time != 0 && now > event_time)
+        {
+            Telemetry::getTelemetry()->addInputLatency(now - event_time);
+        }
+    }
+    
     bool event_handled = false;
     
     if (scene != NULL)
@@ -81,7 +200,7 @@ void SceneManager::onEvent(Event event)
     
     if (event.type == ET_KEY_EVENT)
     {
-        KeyEvent key_event = event.key;
+        const KeyEvent& key_event = event.key;
     
         if (key_event.pressed)
         {
@@ -95,6 +214,26 @@ void SceneManager::onEvent(Event event)
                 case KC_KEY_F:
                     device->setWindowFullscreen(!device->isWindowFullscreen());
                     break;
+                case KC_KEY_P:
+                {
+                    Profiler* profiler = Profiler::getProfiler();
+                    profiler->setOverlayVisible(!profiler->isOverlayVisible());
+                    break;
+                }
+                case KC_KEY_T:
+                {
+                    Telemetry* telemetry = Telemetry::getTelemetry();
+                    std::string path = telemetry->getExportPath();
+                    
+                    if (path.empty())
+                    {
+                        path = FileManager::getFileManager()->getCacheDir() +
+                               "/telemetry.json";
+                    }
+                    
+                    telemetry->exportToFile(path);
+                    break;
+                }
                 default:
                     break;
                 }
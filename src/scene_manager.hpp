@@ -17,6 +17,8 @@
 #ifndef SCENE_MANAGER_HPP
 #define SCENE_MANAGER_HPP
 
+#include "events.hpp"
+
 class Scene
 {
 public:
@@ -24,7 +26,7 @@ public:
     virtual ~Scene() {};
     
     virtual void update(float dt) = 0;
-    virtual bool onEvent(Event event) = 0;
+    virtual bool onEvent(const Event& event) = 0;
 };
 
 class SceneManager
@@ -41,9 +43,10 @@ public:
     bool init();
     bool update(float dt);
     void createScene();
+    void requestRedraw();
     Scene* getScene() {return m_scene;}
     
-    static void onEvent(Event event);
+    static void onEvent(const Event& event);
     static SceneManager* getSceneManager() {return m_scene_manager;}
 };
 
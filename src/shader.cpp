@@ -17,6 +17,8 @@
 #include <cstdio>
 
 #include "file_manager.hpp"
+#include "gl_state.hpp"
+#include "program_cache.hpp"
 #include "shader.hpp"
 
 Shader::Shader()
@@ -24,23 +26,61 @@ Shader::Shader()
     m_vert = 0;
     m_frag = 0;
     m_program = 0;
+    m_features = 0;
 }
 
 Shader::~Shader()
 {
     glDeleteShader(m_vert);
     glDeleteShader(m_frag);
+    
+    GLState::getGLState()->onProgramDeleted(m_program);
     glDeleteProgram(m_program);
 }
 
+// Attrib locations must be set before init() is called. Fixed locations
+// allow different programs to share the same vertex setup.
+void Shader::setAttribLocation(std::string attrib_name, GLuint index)
+{
+    m_attrib_locations[attrib_name] = index;
+}
+
 bool Shader::init(std::string vs_name, std::string fs_name)
 {
-    m_vert = makeShader(GL_VERTEX_SHADER, vs_name);
+    std::string vs_code;
+    std::string fs_code;
+    
+    if (!loadShaderCode(GL_VERTEX_SHADER, vs_name, vs_code))
+        return false;
+        
+    if (!loadShaderCode(GL_FRAGMENT_SHADER, fs_name, fs_code))
+        return false;
+    
+    // Attrib locations are stored in the binary, so they are a part of key
+    ProgramCache* program_cache = ProgramCache::getProgramCache();
+    uint64_t key = ProgramCache::hash(vs_code);
+    key = ProgramCache::hash(fs_code, key);
+    
+    for (auto& attrib : m_attrib_locations)
+    {
+        key = ProgramCache::hash(attrib.first + "=" + 
+                                 std::to_string(attrib.second) + ";", key);
+    }
+    
+    if (program_cache != NULL)
+    {
+        m_program = program_cache->loadProgram(key);
+        
+        if (m_program != 0)
+            return true;
+    }
+    
+    m_vert = makeShader(GL_VERTEX_SHADER, vs_name, vs_code);
     
     if (m_vert == 0)
         return false;
 
-    m_frag = makeShader(GL_FRAGMENT_SHADER, fs_name);
+    m_frag = makeShader(GL_FRAGMENT_SHADER, fs_name, fs_code);
     
     if (m_frag == 0)
         return false;
@@ -50,6 +90,11 @@ bool Shader::init(std::string vs_name, std::string fs_name)
     if (m_program == 0)
         return false;
         
+    if (program_cache != NULL)
+    {
+        program_cache->saveProgram(key, m_program);
+    }
+        
     return true;
 }
 
@@ -67,11 +112,12 @@ bool Shader::assignAttrib(GLint& attrib, std::string attrib_name)
     return true;
 }
 
-bool Shader::assignUniform(GLint& uniform, std::string uniform_name)
+bool Shader::assignUniform(Uniform& uniform, std::string uniform_name)
 {
-    uniform = glGetUniformLocation(m_program, uniform_name.c_str());
+    GLint location = glGetUniformLocation(m_program, uniform_name.c_str());
+    uniform.setLocation(location);
     
-    if (uniform == -1)
+    if (location == -1)
     {
         printf("Error: Failed to get uniform location %s\n", 
                uniform_name.c_str());
@@ -81,15 +127,16 @@ bool Shader::assignUniform(GLint& uniform, std::string uniform_name)
     return true;
 }
 
-GLuint Shader::makeShader(GLenum type, std::string filename)
+bool Shader::loadShaderCode(GLenum type, std::string filename, 
+                            std::string& code)
 {
     FileManager* file_manager = FileManager::getFileManager();
     File* file = file_manager->loadFile(filename);
     
     if (file == NULL)
-        return 0;
+        return false;
 
-    std::string code = "//" + std::string(filename) + "\n";
+    code = "//" + std::string(filename) + "\n";
     
     if (type == GL_FRAGMENT_SHADER)
     {
@@ -108,11 +155,37 @@ GLuint Shader::makeShader(GLenum type, std::string filename)
             code += "precision mediump float;\n";
         }
     }
+    
+    const char* feature_names[SHADER_FEATURES_COUNT] = 
+    {
+        "ALPHA_TEST",
+        "TINT",
+        "COVERAGE"
+    };
+    
+    for (int i = 0; i < SHADER_FEATURES_COUNT; i++)
+    {
+        if (m_features & (1 << i))
+        {
+            code += "#define " + std::string(feature_names[i]) + "\n";
+        }
+    }
+    
+    if (m_features & SF_ALPHA_TEST)
+    {
+        code += "#define ALPHA_TEST_REF 0.5\n";
+    }
 
     code.append(file->data, file->length);
     
     file_manager->closeFile(file);
+    
+    return true;
+}
 
+GLuint Shader::makeShader(GLenum type, std::string filename, 
+                          const std::string& code)
+{
     const char* code_ptr = code.c_str();
     int length = (int)code.size();
     
@@ -151,6 +224,19 @@ GLuint Shader::makeProgram(GLuint vertex_shader, GLuint fragment_shader)
 
     glAttachShader(program, vertex_shader);
     glAttachShader(program, fragment_shader);
+    
+    for (auto& attrib : m_attrib_locations)
+    {
+        glBindAttribLocation(program, attrib.second, attrib.first.c_str());
+    }
+    
+    ProgramCache* program_cache = ProgramCache::getProgramCache();
+    
+    if (program_cache != NULL)
+    {
+        program_cache->prepareProgram(program);
+    }
+    
     glLinkProgram(program);
 
     GLint program_ok;
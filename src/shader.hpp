@@ -19,19 +19,127 @@
 
 #include <GLES3/gl3.h>
 
+#include <cstdio>
+#include <map>
 #include <string>
 
+// Features are injected as defines at the top of both shaders, so that one
+// source file can be compiled into variants that do only the needed work
+enum ShaderFeature
+{
+    SF_ALPHA_TEST = 1 << 0,
+    SF_TINT = 1 << 1,
+    SF_COVERAGE = 1 << 2
+};
+
+#define SHADER_FEATURES_COUNT 3
+
+// Uniform location with the last value that was set. Values are a part of
+// the program state, so glUniform is skipped when the value didn't change.
+// The program must be in use when set() is called.
+class Uniform
+{
+protected:
+    GLint m_location;
+    bool m_known;
+
+public:
+    Uniform() : m_location(-1), m_known(false) {}
+    
+    void setLocation(GLint location) {m_location = location; m_known = false;}
+    GLint getLocation() {return m_location;}
+};
+
+class UniformInt : public Uniform
+{
+private:
+    GLint m_value;
+
+public:
+    void set(GLint value)
+    {
+        if (m_known && m_value == value)
+            return;
+        
+        m_value = value;
+        m_known = true;
+        glUniform1i(m_location, value);
+    }
+};
+
+class UniformFloat : public Uniform
+{
+private:
+    GLfloat m_value;
+
+public:
+    void set(GLfloat value)
+    {
+        if (m_known && m_value == value)
+            return;
+        
+        m_value = value;
+        m_known = true;
+        glUniform1f(m_location, value);
+    }
+};
+
+class UniformVec2 : public Uniform
+{
+private:
+    GLfloat m_value[2];
+
+public:
+    void set(GLfloat x, GLfloat y)
+    {
+        if (m_known && m_value[0] == x && m_value[1] == y)
+            return;
+        
+        m_value[0] = x;
+        m_value[1] = y;
+        m_known = true;
+        glUniform2f(m_location, x, y);
+    }
+};
+
+class UniformVec4 : public Uniform
+{
+private:
+    GLfloat m_value[4];
+
+public:
+    void set(const GLfloat value[4])
+    {
+        if (m_known && m_value[0] == value[0] && m_value[1] == value[1] &&
+            m_value[2] == value[2] && m_value[3] == value[3])
+            return;
+        
+        for (int i = 0; i < 4; i++)
+        {
+            m_value[i] = value[i];
+        }
+        
+        m_known = true;
+        glUniform4fv(m_location, 1, value);
+    }
+};
+
 class Shader
 {
 protected:
     GLuint m_program;
     GLuint m_vert;
     GLuint m_frag;
+    unsigned int m_features;
+    std::map<std::string, GLuint> m_attrib_locations;
     
+    void setAttribLocation(std::string attrib_name, GLuint index);
     bool init(std::string vs_name, std::string fs_name);
     bool assignAttrib(GLint& attrib, std::string attrib_name);
-    bool assignUniform(GLint& uniform, std::string uniform_name);
-    GLuint makeShader(GLenum type, std::string filename);
+    bool assignUniform(Uniform& uniform, std::string uniform_name);
+    bool loadShaderCode(GLenum type, std::string filename, std::string& code);
+    GLuint makeShader(GLenum type, std::string filename, 
+                      const std::string& code);
     GLuint makeProgram(GLuint vertex_shader, GLuint fragment_shader);
     
 public:
@@ -40,9 +148,53 @@ public:
 
     virtual bool create() = 0;
     
+    // Must be called before create()
+    void setFeatures(unsigned int features) {m_features = features;}
+    unsigned int getFeatures() {return m_features;}
     GLuint getProgram() {return m_program;}
     GLuint getVert() {return m_vert;}
     GLuint getFrag() {return m_frag;}
 };
 
+// Programs of one type compiled with different features. Variants are
+// compiled on first use and kept until the end, so the ones that are used 
+// while drawing should be requested during initialization.
+template<class T>
+class ShaderVariants
+{
+private:
+    std::map<unsigned int, T*> m_variants;
+
+public:
+    ~ShaderVariants()
+    {
+        for (auto& variant : m_variants)
+        {
+            delete variant.second;
+        }
+    }
+    
+    // Returns NULL if the variant couldn't be compiled
+    T* get(unsigned int features)
+    {
+        auto it = m_variants.find(features);
+        
+        if (it != m_variants.end())
+            return it->second;
+            
+        T* variant = new T();
+        variant->setFeatures(features);
+        
+        if (!variant->create())
+        {
+            printf("Error: Couldn't create shader variant 0x%x\n", features);
+            delete variant;
+            variant = NULL;
+        }
+        
+        m_variants[features] = variant;
+        return variant;
+    }
+};
+
 #endif
@@ -0,0 +1,77 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded queue for one producer thread and one consumer thread. Each side
+// writes only its own index, so push and pop don't need any lock. The indices
+// are padded to separate cache lines, so that the threads don't invalidate
+// each other's line on every item.
+template<class T, unsigned int N>
+class SPSCQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Size must be a power of two");
+
+private:
+    T m_items[N];
+    char m_padding1[64];
+    std::atomic<unsigned int> m_head;
+    char m_padding2[64];
+    std::atomic<unsigned int> m_tail;
+    char m_padding3[64];
+
+public:
+    SPSCQueue() : m_head(0), m_tail(0) {}
+
+    // Producer only. Returns false when the queue is full.
+    bool push(const T& item)
+    {
+        unsigned int tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_head.load(std::memory_order_acquire) == N)
+            return false;
+
+        m_items[tail & (N - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when the queue is empty.
+    bool pop(T& item)
+    {
+        unsigned int head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        item = m_items[head & (N - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool isEmpty()
+    {
+        unsigned int head = m_head.load(std::memory_order_relaxed);
+        return head == m_tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif
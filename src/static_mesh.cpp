@@ -0,0 +1,171 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_manager.hpp"
+#include "gl_state.hpp"
+#include "static_mesh.hpp"
+#include "telemetry.hpp"
+
+StaticMesh::StaticMesh()
+{
+    m_vbo = 0;
+    m_vao = 0;
+    m_window_width = 0;
+    m_window_height = 0;
+}
+
+StaticMesh::~StaticMesh()
+{
+    GLState* gl_state = GLState::getGLState();
+
+    if (m_vao != 0)
+    {
+        gl_state->onVertexArrayDeleted(m_vao);
+        glDeleteVertexArrays(1, &m_vao);
+    }
+
+    gl_state->onBufferDeleted(m_vbo);
+    glDeleteBuffers(1, &m_vbo);
+}
+
+void StaticMesh::begin()
+{
+    m_sprites.clear();
+}
+
+void StaticMesh::addQuad(Texture* texture, SpriteType type, int pos_x, 
+                         int pos_y, int width, int height, 
+                         const float tex_coords[4], const GLfloat color[4])
+{
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+
+    if ((int)m_sprites.size() >= draw_utils->getMaxQuadsCount())
+        return;
+
+    Sprite sprite;
+    draw_utils->makeSprite(texture, type, pos_x, pos_y, width, height, 
+                           tex_coords, color, sprite);
+    m_sprites.push_back(sprite);
+}
+
+void StaticMesh::addTexture(Texture* texture, int pos_x, int pos_y, 
+                            int width, int height)
+{
+    float tex_coords[4] = {0.0f, 0.0f, texture->tex_w, texture->tex_h};
+    GLfloat color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    addQuad(texture, SPRITE_TEXTURE, pos_x, pos_y, width, height, tex_coords,
+            color);
+}
+
+void StaticMesh::end()
+{
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+    GLState* gl_state = GLState::getGLState();
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+
+    m_window_width = device->getWindowWidth();
+    m_window_height = device->getWindowHeight();
+
+    // Quads are kept in the order in which they were added, only the
+    // neighbours with the same state are merged into one draw call
+    std::vector<SpriteVertex> vertices(m_sprites.size() * 4);
+    m_ranges.clear();
+
+    for (unsigned int i = 0; i < m_sprites.size(); i++)
+    {
+        const Sprite& sprite = m_sprites[i];
+        draw_utils->getSpriteVertices(sprite, &vertices[i * 4]);
+
+        if (m_ranges.empty() || 
+            m_ranges.back().sprite.texture->id != sprite.texture->id ||
+            m_ranges.back().sprite.features != sprite.features ||
+            m_ranges.back().sprite.blend != sprite.blend)
+        {
+            StaticMeshRange range;
+            range.sprite = sprite;
+            range.first = i;
+            range.count = 0;
+            m_ranges.push_back(range);
+        }
+
+        m_ranges.back().count++;
+    }
+
+    if (m_vbo == 0)
+    {
+        glGenBuffers(1, &m_vbo);
+    }
+
+    if (m_vao == 0 && gl_state->hasVertexArrays())
+    {
+        glGenVertexArrays(1, &m_vao);
+        gl_state->bindVertexArray(m_vao);
+        gl_state->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        gl_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 
+                             draw_utils->getQuadIndexBuffer());
+        draw_utils->setSpriteAttribs(0);
+        gl_state->bindVertexArray(0);
+    }
+
+    gl_state->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+    if (!vertices.empty())
+    {
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SpriteVertex),
+                     &vertices[0], GL_STATIC_DRAW);
+        Telemetry::getTelemetry()->addUploadBytes(vertices.size() * 
+                                                  sizeof(SpriteVertex));
+    }
+}
+
+bool StaticMesh::isOutdated()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+
+    return device->getWindowWidth() != m_window_width ||
+           device->getWindowHeight() != m_window_height;
+}
+
+void StaticMesh::draw()
+{
+    if (m_ranges.empty())
+        return;
+
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+    GLState* gl_state = GLState::getGLState();
+
+    draw_utils->flush();
+
+    if (m_vao != 0)
+    {
+        gl_state->bindVertexArray(m_vao);
+    }
+    else
+    {
+        gl_state->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        gl_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 
+                             draw_utils->getQuadIndexBuffer());
+        draw_utils->setSpriteAttribs(0);
+    }
+
+    for (const StaticMeshRange& range : m_ranges)
+    {
+        draw_utils->drawSpriteRange(range.sprite, range.first, range.count);
+    }
+
+    gl_state->bindVertexArray(0);
+}
@@ -0,0 +1,59 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef STATIC_MESH_HPP
+#define STATIC_MESH_HPP
+
+#include "draw_utils.hpp"
+
+#include <vector>
+
+struct StaticMeshRange
+{
+    Sprite sprite;
+    int first;
+    int count;
+};
+
+// Quads that only change on window resize. They are uploaded once to a
+// static vertex buffer, and on GLES3 the whole vertex setup is stored in
+// a vertex array object, so drawing needs only a single bind.
+class StaticMesh
+{
+private:
+    GLuint m_vbo;
+    GLuint m_vao;
+    unsigned int m_window_width;
+    unsigned int m_window_height;
+    std::vector<Sprite> m_sprites;
+    std::vector<StaticMeshRange> m_ranges;
+
+public:
+    StaticMesh();
+    ~StaticMesh();
+
+    void begin();
+    void addQuad(Texture* texture, SpriteType type, int pos_x, int pos_y, 
+                 int width, int height, const float tex_coords[4], 
+                 const GLfloat color[4]);
+    void addTexture(Texture* texture, int pos_x, int pos_y, int width, 
+                    int height);
+    void end();
+    void draw();
+    bool isOutdated();
+};
+
+#endif
@@ -0,0 +1,303 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "file_manager.hpp"
+#include "telemetry.hpp"
+
+#include <cstring>
+
+Telemetry* Telemetry::m_telemetry = NULL;
+
+static const char* g_metric_names[TM_COUNT][2] =
+{
+    {"frame_time", "us"},
+    {"draw_calls", "calls"},
+    {"texture_binds", "binds"},
+    {"upload_bytes", "bytes"},
+    {"input_latency", "us"}
+};
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+void Histogram::reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+int Histogram::getBucket(uint64_t value)
+{
+    const int sub_count = 1 << HISTOGRAM_SUB_BITS;
+    const int half_count = sub_count / 2;
+
+    if (value < (uint64_t)sub_count)
+        return value;
+
+    int highest_bit = 63 - __builtin_clzll(value);
+    int shift = highest_bit - (HISTOGRAM_SUB_BITS - 1);
+
+    return shift * half_count + (int)(value >> shift);
+}
+
+uint64_t Histogram::getBucketMaxValue(int bucket)
+{
+    const int sub_count = 1 << HISTOGRAM_SUB_BITS;
+    const int half_count = sub_count / 2;
+
+    if (bucket < sub_count)
+        return bucket;
+
+    int shift = bucket / half_count - 1;
+    uint64_t sub_bucket = bucket - shift * half_count;
+
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void Histogram::add(uint64_t value)
+{
+    const uint64_t max_value = ((uint64_t)1 << HISTOGRAM_MAX_BITS) - 1;
+
+    if (value > max_value)
+    {
+        value = max_value;
+    }
+
+    m_buckets[getBucket(value)]++;
+    m_count++;
+    m_sum += value;
+
+    if (value > m_max)
+    {
+        m_max = value;
+    }
+}
+
+// Returns the highest value that falls into the same bucket as the value at
+// the given percentile, so the result is never lower than the real value
+uint64_t Histogram::getPercentile(double percentile)
+{
+    if (m_count == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)(percentile / 100.0 * m_count + 0.5);
+
+    if (target < 1)
+    {
+        target = 1;
+    }
+
+    uint64_t count = 0;
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        count += m_buckets[i];
+
+        if (count >= target)
+        {
+            uint64_t value = getBucketMaxValue(i);
+            return value < m_max ? value : m_max;
+        }
+    }
+
+    return m_max;
+}
+
+Telemetry::Telemetry()
+{
+    m_draw_calls = 0;
+    m_texture_binds = 0;
+    m_upload_bytes = 0;
+    m_stalls = 0;
+    m_missed_deadlines = 0;
+    m_telemetry = this;
+}
+
+Telemetry::~Telemetry()
+{
+    m_telemetry = NULL;
+}
+
+// Frame and stage times are taken from the profiler, which has just finished
+// the same frame. The profiler starts the frame after the wait for events, so
+// idle time is not counted. GPU time is known only a few frames later, so
+// it's not included. Returns false if nothing was drawn.
+bool Telemetry::endFrame()
+{
+    if (m_draw_calls == 0)
+        return false;
+
+    Profiler* profiler = Profiler::getProfiler();
+    float frame_ms = profiler->getLastFrameTime(PS_FRAME);
+    unsigned long frame_time = (unsigned long)(frame_ms * 1000.0f);
+
+    m_metrics[TM_FRAME_TIME].add(frame_time);
+    m_metrics[TM_DRAW_CALLS].add(m_draw_calls);
+    m_metrics[TM_TEXTURE_BINDS].add(m_texture_binds);
+    m_metrics[TM_UPLOAD_BYTES].add(m_upload_bytes);
+
+    if (frame_time > TELEMETRY_STALL_US)
+    {
+        m_stalls++;
+    }
+
+    for (int i = 0; i < PS_COUNT; i++)
+    {
+        if (i == PS_FRAME || i == PS_GPU)
+            continue;
+
+        float time_ms = profiler->getLastFrameTime((ProfilerSection)i);
+        m_stages[i].add((uint64_t)(time_ms * 1000.0f));
+    }
+
+    m_draw_calls = 0;
+    m_texture_binds = 0;
+    m_upload_bytes = 0;
+
+    return true;
+}
+
+// Metrics are followed by the profiler stages. Returns NULL for stages that
+// are not recorded.
+Histogram* Telemetry::getHistogram(int index, std::string& name, 
+                                   std::string& unit)
+{
+    if (index < TM_COUNT)
+    {
+        name = g_metric_names[index][0];
+        unit = g_metric_names[index][1];
+        return &m_metrics[index];
+    }
+
+    int stage = index - TM_COUNT;
+
+    if (stage == PS_FRAME || stage == PS_GPU)
+        return NULL;
+
+    name = "cpu_";
+    name += Profiler::getSectionName(stage);
+
+    for (char& c : name)
+    {
+        if (c == ' ')
+        {
+            c = '_';
+        }
+    }
+
+    unit = "us";
+    return &m_stages[stage];
+}
+
+void Telemetry::writeJSON(FILE* file)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "    \"frames\": %llu,\n",
+            (unsigned long long)m_metrics[TM_FRAME_TIME].getCount());
+    fprintf(file, "    \"stalls\": %u,\n", m_stalls);
+    fprintf(file, "    \"stall_threshold_us\": %d,\n", TELEMETRY_STALL_US);
+    fprintf(file, "    \"missed_job_deadlines\": %u,\n", m_missed_deadlines);
+    fprintf(file, "    \"metrics\": [");
+
+    bool first = true;
+
+    for (int i = 0; i < TM_COUNT + PS_COUNT; i++)
+    {
+        std::string name;
+        std::string unit;
+        Histogram* histogram = getHistogram(i, name, unit);
+
+        if (histogram == NULL)
+            continue;
+
+        fprintf(file, "%s\n        {\"name\": \"%s\", \"unit\": \"%s\", "
+                "\"count\": %llu, \"mean\": %.1f, \"p50\": %llu, "
+                "\"p90\": %llu, \"p99\": %llu, \"max\": %llu}",
+                first ? "" : ",", name.c_str(), unit.c_str(),
+                (unsigned long long)histogram->getCount(),
+                histogram->getMean(),
+                (unsigned long long)histogram->getPercentile(50.0),
+                (unsigned long long)histogram->getPercentile(90.0),
+                (unsigned long long)histogram->getPercentile(99.0),
+                (unsigned long long)histogram->getMax());
+
+        first = false;
+    }
+
+    fprintf(file, "\n    ]\n}\n");
+}
+
+void Telemetry::writeCSV(FILE* file)
+{
+    fprintf(file, "metric,unit,count,mean,p50,p90,p99,max\n");
+
+    for (int i = 0; i < TM_COUNT + PS_COUNT; i++)
+    {
+        std::string name;
+        std::string unit;
+        Histogram* histogram = getHistogram(i, name, unit);
+
+        if (histogram == NULL)
+            continue;
+
+        fprintf(file, "%s,%s,%llu,%.1f,%llu,%llu,%llu,%llu\n", name.c_str(),
+                unit.c_str(), (unsigned long long)histogram->getCount(),
+                histogram->getMean(),
+                (unsigned long long)histogram->getPercentile(50.0),
+                (unsigned long long)histogram->getPercentile(90.0),
+                (unsigned long long)histogram->getPercentile(99.0),
+                (unsigned long long)histogram->getMax());
+    }
+
+    fprintf(file, "\nframes,stalls,stall_threshold_us,missed_job_deadlines\n");
+    fprintf(file, "%llu,%u,%d,%u\n",
+            (unsigned long long)m_metrics[TM_FRAME_TIME].getCount(),
+            m_stalls, TELEMETRY_STALL_US, m_missed_deadlines);
+}
+
+// The format is chosen by the file extension, JSON is used by default
+bool Telemetry::exportToFile(std::string path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+
+    if (file == NULL)
+    {
+        printf("Error: Couldn't open telemetry output file %s.\n",
+               path.c_str());
+        return false;
+    }
+
+    FileManager* file_manager = FileManager::getFileManager();
+
+    if (file_manager->getExtension(path) == ".csv")
+    {
+        writeCSV(file);
+    }
+    else
+    {
+        writeJSON(file);
+    }
+
+    fclose(file);
+
+    printf("Telemetry data saved to %s.\n", path.c_str());
+
+    return true;
+}
@@ -0,0 +1,109 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include "profiler.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Values are grouped by the highest bit and then split into linear sub
+// buckets, so the relative error is below 1/16 for any value up to 2^36
+#define HISTOGRAM_SUB_BITS 5
+#define HISTOGRAM_MAX_BITS 36
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 2) * \
+                           (1 << (HISTOGRAM_SUB_BITS - 1)))
+
+#define TELEMETRY_STALL_US 33000
+
+// Fixed size histogram in the style of HdrHistogram, so that adding a value
+// doesn't allocate anything
+class Histogram
+{
+private:
+    unsigned int m_buckets[HISTOGRAM_BUCKETS];
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_max;
+
+    static int getBucket(uint64_t value);
+    static uint64_t getBucketMaxValue(int bucket);
+
+public:
+    Histogram();
+
+    void reset();
+    void add(uint64_t value);
+    uint64_t getPercentile(double percentile);
+    uint64_t getCount() {return m_count;}
+    uint64_t getMax() {return m_max;}
+    double getMean() {return m_count > 0 ? (double)m_sum / m_count : 0.0;}
+};
+
+enum TelemetryMetric
+{
+    TM_FRAME_TIME,
+    TM_DRAW_CALLS,
+    TM_TEXTURE_BINDS,
+    TM_UPLOAD_BYTES,
+    TM_INPUT_LATENCY,
+    TM_COUNT
+};
+
+// Statistics of the whole run for comparing builds and devices. Counters are
+// incremented where the work is done and they are added to the histograms at
+// the end of each drawn frame. Iterations that don't draw anything are not
+// counted as frames, and their uploads go to the next frame.
+class Telemetry
+{
+private:
+    Histogram m_metrics[TM_COUNT];
+    Histogram m_stages[PS_COUNT];
+    unsigned int m_draw_calls;
+    unsigned int m_texture_binds;
+    uint64_t m_upload_bytes;
+    unsigned int m_stalls;
+    unsigned int m_missed_deadlines;
+    std::string m_export_path;
+
+    static Telemetry* m_telemetry;
+
+    Histogram* getHistogram(int index, std::string& name, std::string& unit);
+    void writeJSON(FILE* file);
+    void writeCSV(FILE* file);
+
+public:
+    Telemetry();
+    ~Telemetry();
+
+    bool endFrame();
+    void addDrawCall() {m_draw_calls++;}
+    void addTextureBind() {m_texture_binds++;}
+    void addUploadBytes(uint64_t bytes) {m_upload_bytes += bytes;}
+    void addMissedDeadline() {m_missed_deadlines++;}
+    // Input latency is recorded per event, not per frame
+    void addInputLatency(uint64_t time) {m_metrics[TM_INPUT_LATENCY].add(time);}
+    bool exportToFile(std::string path);
+    void setExportPath(std::string path) {m_export_path = path;}
+    std::string getExportPath() {return m_export_path;}
+
+    static Telemetry* getTelemetry() {return m_telemetry;}
+};
+
+#endif
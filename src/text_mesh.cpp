@@ -0,0 +1,186 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_manager.hpp"
+#include "draw_utils.hpp"
+#include "font_manager.hpp"
+#include "gl_state.hpp"
+#include "telemetry.hpp"
+#include "text_mesh.hpp"
+#include "utf8.hpp"
+
+TextMesh::TextMesh()
+{
+    m_vbo = 0;
+    m_size = 0;
+    m_width = 0;
+    m_window_width = 0;
+    m_window_height = 0;
+    m_atlas_generation = 0;
+    m_dirty = true;
+}
+
+TextMesh::~TextMesh()
+{
+    GLState::getGLState()->onBufferDeleted(m_vbo);
+    glDeleteBuffers(1, &m_vbo);
+}
+
+void TextMesh::setText(std::string text, std::string font_name, int size)
+{
+    if (text == m_text && font_name == m_font_name && size == m_size)
+        return;
+
+    m_text = text;
+    m_font_name = font_name;
+    m_size = size;
+    m_dirty = true;
+}
+
+void TextMesh::setText(std::string text)
+{
+    setText(text, m_font_name, m_size);
+}
+
+void TextMesh::updateDirtyState()
+{
+    // Placeholders of glyphs that were rendered in background are replaced
+    // with real glyphs when the atlas changes
+    FontManager* font_manager = FontManager::getFontManager();
+
+    if (font_manager->getAtlasGeneration() != m_atlas_generation)
+    {
+        m_dirty = true;
+    }
+
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+
+    if (device->getWindowWidth() == m_window_width &&
+        device->getWindowHeight() == m_window_height)
+        return;
+
+    m_window_width = device->getWindowWidth();
+    m_window_height = device->getWindowHeight();
+    m_dirty = true;
+}
+
+void TextMesh::rebuild()
+{
+    FontManager* font_manager = FontManager::getFontManager();
+    font_manager->changeFont(m_font_name);
+    m_atlas_generation = font_manager->getAtlasGeneration();
+
+    // Vertices are relative to the text origin, so that moving the text
+    // doesn't require rebuilding the buffer
+    float scale_x = 2.0f / m_window_width;
+    float scale_y = 2.0f / m_window_height;
+
+    std::vector<GLfloat> vertices;
+    vertices.reserve(m_text.size() * 6 * 4);
+    m_ranges.clear();
+    m_width = 0;
+
+    UTF8Iterator it(m_text);
+    uint32_t c;
+
+    while (it.next(c))
+    {
+        Glyph* glyph = font_manager->getGlyph(c, m_size);
+
+        if (glyph == NULL)
+            continue;
+
+        if (glyph->texture != NULL)
+        {
+            if (m_ranges.empty() || m_ranges.back().texture != glyph->texture)
+            {
+                TextMeshRange range;
+                range.texture = glyph->texture;
+                range.first = vertices.size() / 4;
+                range.count = 0;
+                m_ranges.push_back(range);
+            }
+
+            float x = (m_width + glyph->left) * scale_x;
+            float y = -glyph->top * scale_y;
+            float w = glyph->width * scale_x;
+            float h = glyph->height * scale_y;
+            float u0 = glyph->tex_coords[0];
+            float v0 = glyph->tex_coords[1];
+            float u1 = glyph->tex_coords[2];
+            float v1 = glyph->tex_coords[3];
+
+            GLfloat quad[6][4] = { {x, -y,         u0, v0},
+                                   {x + w, -y,     u1, v0},
+                                   {x, -y - h,     u0, v1},
+                                   {x + w, -y,     u1, v0},
+                                   {x + w, -y - h, u1, v1},
+                                   {x, -y - h,     u0, v1} };
+
+            vertices.insert(vertices.end(), &quad[0][0], &quad[0][0] + 24);
+            m_ranges.back().count += 6;
+        }
+
+        m_width += glyph->advance;
+    }
+
+    if (m_vbo == 0)
+    {
+        glGenBuffers(1, &m_vbo);
+    }
+
+    GLState::getGLState()->bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+    if (!vertices.empty())
+    {
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat),
+                     &vertices[0], GL_STATIC_DRAW);
+        Telemetry::getTelemetry()->addUploadBytes(vertices.size() * 
+                                                  sizeof(GLfloat));
+    }
+
+    m_dirty = false;
+}
+
+int TextMesh::getWidth()
+{
+    updateDirtyState();
+
+    if (m_dirty)
+    {
+        rebuild();
+    }
+
+    return m_width;
+}
+
+void TextMesh::draw(int pos_x, int pos_y, GLfloat color[4])
+{
+    updateDirtyState();
+
+    if (m_dirty)
+    {
+        rebuild();
+    }
+
+    DrawUtils* draw_utils = DrawUtils::getDrawUtils();
+
+    for (const TextMeshRange& range : m_ranges)
+    {
+        draw_utils->drawTextBuffer(m_vbo, range.texture, range.first,
+                                   range.count, pos_x, pos_y, color);
+    }
+}
@@ -0,0 +1,63 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TEXT_MESH_HPP
+#define TEXT_MESH_HPP
+
+#include "texture_manager.hpp"
+
+#include <string>
+#include <vector>
+
+struct TextMeshRange
+{
+    Texture* texture;
+    int first;
+    int count;
+};
+
+// Text that is laid out once and kept in a vertex buffer. The buffer is
+// rebuilt only when the text, font, size or window size changes, so that
+// drawing static labels doesn't touch the glyph cache on every frame.
+class TextMesh
+{
+private:
+    GLuint m_vbo;
+    std::string m_text;
+    std::string m_font_name;
+    int m_size;
+    int m_width;
+    unsigned int m_window_width;
+    unsigned int m_window_height;
+    unsigned int m_atlas_generation;
+    bool m_dirty;
+    std::vector<TextMeshRange> m_ranges;
+
+    void rebuild();
+    void updateDirtyState();
+
+public:
+    TextMesh();
+    ~TextMesh();
+
+    void setText(std::string text, std::string font_name, int size);
+    void setText(std::string text);
+    void draw(int pos_x, int pos_y, GLfloat color[4]);
+    int getWidth();
+    std::string getText() {return m_text;}
+};
+
+#endif
@@ -14,9 +14,13 @@
 //    You should have received a copy of the GNU General Public License
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include "device_manager.hpp"
 #include "file_manager.hpp"
+#include "gl_state.hpp"
 #include "image_loader.hpp"
+#include "telemetry.hpp"
 #include "texture_manager.hpp"
+#include "texture_uploader.hpp"
 
 #include <cstring>
 
@@ -26,10 +30,26 @@ TextureManager::TextureManager()
 {
     m_texture_manager = this;
     m_supports_npot = false;
+    m_uploader = NULL;
 }
 
 TextureManager::~TextureManager()
 {
+    delete m_uploader;
+    
+    for (TextureUpload& upload : m_uploads)
+    {
+        if (upload.fence != 0)
+        {
+            glDeleteSync(upload.fence);
+        }
+        
+        if (upload.texture != NULL)
+        {
+            deleteTexture(upload.texture);
+        }
+    }
+    
     for (auto texture : m_textures)
     {
         deleteTexture(texture.second);
@@ -51,6 +71,16 @@ bool TextureManager::init()
         m_supports_npot = false;
     }    
     
+    // Textures are created on the render thread when the upload context
+    // can't be used
+    m_uploader = new TextureUploader();
+    
+    if (!m_uploader->init())
+    {
+        delete m_uploader;
+        m_uploader = NULL;
+    }
+    
     loadTextures();
     
     return true;
@@ -63,6 +93,17 @@ void TextureManager::loadTextures()
     
     for (std::string name : assets_list)
     {
+        // Images from the add-ons that are extracted by the installer are 
+        // not used by the UI
+        if (name.find("extract/") == 0)
+            continue;
+        
+        if (m_uploader != NULL)
+        {
+            m_uploader->requestTexture(name);
+            continue;
+        }
+        
         Image* image = ImageLoader::loadImage(name);
         
         if (image == NULL)
@@ -74,6 +115,126 @@ void TextureManager::loadTextures()
     }
 }
 
+void TextureManager::requestTexture(std::string name)
+{
+    if (m_textures.find(name) != m_textures.end())
+        return;
+    
+    if (m_uploader != NULL)
+    {
+        for (TextureUpload& upload : m_uploads)
+        {
+            if (upload.name == name)
+                return;
+        }
+        
+        m_uploader->requestTexture(name);
+        return;
+    }
+    
+    Image* image = ImageLoader::loadImage(name);
+    
+    if (image == NULL)
+        return;
+    
+    m_textures[name] = createTexture(image->width, image->height,
+                                     image->channels, image->data);
+    ImageLoader::closeImage(image);
+}
+
+// Takes textures from the upload thread once the GPU has finished them, so
+// that drawing never waits for an upload
+void TextureManager::update()
+{
+    if (m_uploader == NULL)
+        return;
+    
+    m_uploader->getResults(m_uploads);
+    
+    for (unsigned int i = 0; i < m_uploads.size();)
+    {
+        TextureUpload& upload = m_uploads[i];
+        
+        if (upload.fence != 0 && 
+            glClientWaitSync(upload.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            i++;
+            continue;
+        }
+        
+        addUploadedTexture(upload);
+        m_uploads.erase(m_uploads.begin() + i);
+    }
+}
+
+void TextureManager::addUploadedTexture(const TextureUpload& upload)
+{
+    if (upload.fence != 0)
+    {
+        glDeleteSync(upload.fence);
+    }
+    
+    if (upload.texture == NULL)
+        return;
+    
+    m_textures[upload.name] = upload.texture;
+    Telemetry::getTelemetry()->addUploadBytes(upload.size);
+    
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    device->requestRedraw();
+}
+
+// A texture that is still being uploaded is needed right now, so the render
+// thread waits for it. The fence wait is done on the GPU side.
+Texture* TextureManager::getTexture(std::string name)
+{
+    auto it = m_textures.find(name);
+    
+    if (it != m_textures.end())
+        return it->second;
+    
+    if (m_uploader == NULL)
+        return NULL;
+    
+    TextureUpload upload;
+    bool found = false;
+    
+    for (unsigned int i = 0; i < m_uploads.size(); i++)
+    {
+        if (m_uploads[i].name != name)
+            continue;
+        
+        upload = m_uploads[i];
+        m_uploads.erase(m_uploads.begin() + i);
+        found = true;
+        break;
+    }
+    
+    if (!found)
+    {
+        found = m_uploader->waitForTexture(name, upload);
+    }
+    
+    if (!found)
+        return NULL;
+    
+    if (upload.fence != 0)
+    {
+        glWaitSync(upload.fence, 0, GL_TIMEOUT_IGNORED);
+    }
+    
+    addUploadedTexture(upload);
+    return upload.texture;
+}
+
+bool TextureManager::hasPendingTextures()
+{
+    if (m_uploader == NULL)
+        return false;
+    
+    return !m_uploads.empty() || m_uploader->hasPendingUploads();
+}
+
 int TextureManager::getPotDimension(int value)
 {
     int value_pot = 1;
@@ -86,13 +247,62 @@ int TextureManager::getPotDimension(int value)
     return value_pot;
 }
 
-Texture* TextureManager::createTexture(int width, int height, int channels,
-                                       const void* data)
+// Only generates the texture name, so that it can be also used by the upload
+// thread
+Texture* TextureManager::newTexture(int width, int height, int channels)
+{
+    if (channels != 1 && channels != 3 && channels != 4)
+        return NULL;
+
+    Texture* texture = new Texture();
+    texture->width = width;
+    texture->height = height;
+    texture->channels = channels;
+    texture->alpha = (channels == 3) ? TA_OPAQUE : TA_BLEND;
+    texture->tex_w = 1.0f;
+    texture->tex_h = 1.0f;
+    
+    glGenTextures(1, &texture->id);
+    
+    return texture;
+}
+
+// Images are checked when they are loaded, so that for example an RGBA image
+// without any transparent pixel is drawn as opaque. Other textures keep the
+// alpha that was set by newTexture.
+TextureAlpha TextureManager::getTextureAlpha(Texture* texture, 
+                                             const void* data)
+{
+    if (texture->channels != 4 || data == NULL)
+        return texture->alpha;
+    
+    const unsigned char* pixels = (const unsigned char*)data;
+    int pixels_count = texture->width * texture->height;
+    bool opaque = true;
+    
+    for (int i = 0; i < pixels_count; i++)
+    {
+        unsigned char alpha = pixels[i * 4 + 3];
+        
+        if (alpha != 0 && alpha != 255)
+            return TA_BLEND;
+        
+        if (alpha == 0)
+        {
+            opaque = false;
+        }
+    }
+    
+    return opaque ? TA_OPAQUE : TA_BINARY;
+}
+
+// Sets parameters and storage of the texture that is currently bound
+void TextureManager::initTexture(Texture* texture, const void* data)
 {
     GLint internal_format;
     GLenum format;
         
-    switch (channels)
+    switch (texture->channels)
     {
     case 1:
         format = GL_LUMINANCE;
@@ -107,23 +317,20 @@ Texture* TextureManager::createTexture(int width, int height, int channels,
         internal_format = GL_RGBA;
         break;
     default:
-        return NULL;
+        return;
     }
     
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    Texture* texture = new Texture();
-    texture->width = width;
-    texture->height = height;
-    texture->channels = channels;
+    texture->alpha = getTextureAlpha(texture, data);
     
-    glGenTextures(1, &texture->id);
-    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    
+    int width = texture->width;
+    int height = texture->height;
         
     if (m_supports_npot)
     {
@@ -142,17 +349,67 @@ Texture* TextureManager::createTexture(int width, int height, int channels,
         
         glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width_pot, height_pot, 
                      0, format, GL_UNSIGNED_BYTE, NULL);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, 
-                        GL_UNSIGNED_BYTE, data);
+        
+        if (data != NULL)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, 
+                            GL_UNSIGNED_BYTE, data);
+        }
     }
+}
+
+Texture* TextureManager::createTexture(int width, int height, int channels,
+                                       const void* data)
+{
+    Texture* texture = newTexture(width, height, channels);
+    
+    if (texture == NULL)
+        return NULL;
     
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::getGLState()->bindTexture(texture->id);
+    initTexture(texture, data);
+    
+    if (data != NULL)
+    {
+        Telemetry::getTelemetry()->addUploadBytes(width * height * channels);
+    }
     
     return texture;
 }
 
+void TextureManager::updateTexture(Texture* texture, int pos_x, int pos_y,
+                                   int width, int height, const void* data)
+{
+    GLenum format;
+    
+    switch (texture->channels)
+    {
+    case 1:
+        format = GL_LUMINANCE;
+        break;
+    case 3:
+        format = GL_RGB;
+        break;
+    case 4:
+        format = GL_RGBA;
+        break;
+    default:
+        return;
+    }
+    
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    
+    GLState::getGLState()->bindTexture(texture->id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, pos_x, pos_y, width, height, format, 
+                    GL_UNSIGNED_BYTE, data);
+    
+    Telemetry::getTelemetry()->addUploadBytes(width * height * 
+                                              texture->channels);
+}
+
 void TextureManager::deleteTexture(Texture* texture)
 {
+    GLState::getGLState()->onTextureDeleted(texture->id);
     glDeleteTextures(1, &texture->id);
     
     delete texture;
@@ -21,6 +21,18 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+class TextureUploader;
+
+// How the texture uses its alpha channel, so that it can be drawn without
+// blending when it's not needed
+enum TextureAlpha
+{
+    TA_OPAQUE,
+    TA_BINARY,
+    TA_BLEND
+};
 
 struct Texture
 {
@@ -30,6 +42,17 @@ struct Texture
     float tex_w;
     float tex_h;
     int channels;
+    TextureAlpha alpha;
+};
+
+// Texture that was uploaded in background, with the fence that signals when
+// it can be used for drawing
+struct TextureUpload
+{
+    std::string name;
+    Texture* texture;
+    GLsync fence;
+    unsigned int size;
 };
 
 class TextureManager
@@ -37,20 +60,31 @@ class TextureManager
 private:
     bool m_supports_npot;
     std::map<std::string, Texture*> m_textures;
+    TextureUploader* m_uploader;
+    std::vector<TextureUpload> m_uploads;
     static TextureManager* m_texture_manager;
     
     void loadTextures();
     int getPotDimension(int value);
+    void addUploadedTexture(const TextureUpload& upload);
+    TextureAlpha getTextureAlpha(Texture* texture, const void* data);
 
 public:
     TextureManager();
     ~TextureManager();
     
     bool init();
+    void update();
+    Texture* newTexture(int width, int height, int channels);
+    void initTexture(Texture* texture, const void* data);
     Texture* createTexture(int width, int height, int channels, 
                            const void* data);
+    void updateTexture(Texture* texture, int pos_x, int pos_y, int width,
+                       int height, const void* data);
     void deleteTexture(Texture* texture);
-    Texture* getTexture(std::string name) {return m_textures[name];}
+    Texture* getTexture(std::string name);
+    void requestTexture(std::string name);
+    bool hasPendingTextures();
     
     static TextureManager* getTextureManager() {return m_texture_manager;}
 };
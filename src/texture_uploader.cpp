@@ -0,0 +1,225 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_manager.hpp"
+#include "image_loader.hpp"
+#include "texture_uploader.hpp"
+
+TextureUploader::TextureUploader()
+{
+    m_stop = false;
+    m_started = false;
+    m_context_ready = false;
+}
+
+TextureUploader::~TextureUploader()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_condition.notify_all();
+        m_thread.join();
+    }
+
+    // Uploads that were never taken by the render thread
+    for (TextureUpload& upload : m_results)
+    {
+        if (upload.fence != 0)
+        {
+            glDeleteSync(upload.fence);
+        }
+
+        if (upload.texture != NULL)
+        {
+            glDeleteTextures(1, &upload.texture->id);
+            delete upload.texture;
+        }
+    }
+
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    device->getEGLContext()->destroyUploadContext();
+}
+
+// Returns false when the upload context can't be used, and then textures
+// have to be created on the render thread
+bool TextureUploader::init()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    ContextManagerEGL* egl_context = device->getEGLContext();
+
+    if (egl_context == NULL || !egl_context->createUploadContext())
+        return false;
+
+    m_thread = std::thread(&TextureUploader::run, this);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_results_condition.wait(lock, [this] {return m_started;});
+
+    if (m_context_ready)
+        return true;
+
+    lock.unlock();
+    m_thread.join();
+    return false;
+}
+
+void TextureUploader::run()
+{
+    Device* device = DeviceManager::getDeviceManager()->getDevice();
+    ContextManagerEGL* egl_context = device->getEGLContext();
+    bool success = egl_context->makeUploadContextCurrent();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_context_ready = success;
+        m_started = true;
+    }
+
+    m_results_condition.notify_all();
+
+    if (!success)
+        return;
+
+    while (true)
+    {
+        std::string name;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] {return m_stop || !m_jobs.empty();});
+
+            if (m_stop)
+                break;
+
+            name = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        TextureUpload upload;
+        uploadTexture(name, upload);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(upload);
+        }
+
+        m_results_condition.notify_all();
+    }
+
+    egl_context->releaseUploadContext();
+}
+
+void TextureUploader::uploadTexture(const std::string& name, 
+                                    TextureUpload& upload)
+{
+    upload.name = name;
+    upload.texture = NULL;
+    upload.fence = 0;
+    upload.size = 0;
+
+    Image* image = ImageLoader::loadImage(name);
+
+    if (image == NULL)
+        return;
+
+    TextureManager* texture_manager = TextureManager::getTextureManager();
+    Texture* texture = texture_manager->newTexture(image->width, 
+                                                   image->height,
+                                                   image->channels);
+
+    if (texture != NULL)
+    {
+        // GL state cache belongs to the render thread, so the texture is
+        // bound directly
+        glBindTexture(GL_TEXTURE_2D, texture->id);
+        texture_manager->initTexture(texture, image->data);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // The fence must reach the GPU before the render thread waits for it
+        upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        upload.texture = texture;
+        upload.size = image->width * image->height * image->channels;
+    }
+
+    ImageLoader::closeImage(image);
+}
+
+void TextureUploader::requestTexture(const std::string& name)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_pending.find(name) != m_pending.end())
+            return;
+
+        m_pending.insert(name);
+        m_jobs.push_back(name);
+    }
+
+    m_condition.notify_one();
+}
+
+void TextureUploader::getResults(std::vector<TextureUpload>& results)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (TextureUpload& upload : m_results)
+    {
+        m_pending.erase(upload.name);
+        results.push_back(upload);
+    }
+
+    m_results.clear();
+}
+
+// Blocks until the requested texture is uploaded. Returns false if the
+// texture wasn't requested or it was already taken.
+bool TextureUploader::waitForTexture(const std::string& name, 
+                                     TextureUpload& upload)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_pending.find(name) == m_pending.end())
+        return false;
+
+    while (true)
+    {
+        for (unsigned int i = 0; i < m_results.size(); i++)
+        {
+            if (m_results[i].name != name)
+                continue;
+
+            upload = m_results[i];
+            m_results.erase(m_results.begin() + i);
+            m_pending.erase(name);
+            return true;
+        }
+
+        m_results_condition.wait(lock);
+    }
+}
+
+bool TextureUploader::hasPendingUploads()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_pending.empty();
+}
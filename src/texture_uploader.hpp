@@ -0,0 +1,62 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TEXTURE_UPLOADER_HPP
+#define TEXTURE_UPLOADER_HPP
+
+#include "texture_manager.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loads images and uploads them on a worker thread, which has its own EGL
+// context sharing textures with the render thread. Every upload is followed
+// by a fence, and the render thread uses the texture only after the fence,
+// so that a big image never stalls a frame.
+class TextureUploader
+{
+private:
+    std::thread m_thread;
+    std::deque<std::string> m_jobs;
+    std::vector<TextureUpload> m_results;
+    std::set<std::string> m_pending;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_results_condition;
+    bool m_stop;
+    bool m_started;
+    bool m_context_ready;
+
+    void run();
+    void uploadTexture(const std::string& name, TextureUpload& upload);
+
+public:
+    TextureUploader();
+    ~TextureUploader();
+
+    bool init();
+    void requestTexture(const std::string& name);
+    void getResults(std::vector<TextureUpload>& results);
+    bool waitForTexture(const std::string& name, TextureUpload& upload);
+    bool hasPendingUploads();
+};
+
+#endif
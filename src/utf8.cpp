@@ -0,0 +1,109 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "utf8.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+int UTF8Decoder::countASCII16(const unsigned char* pos)
+{
+#if defined(__SSE2__)
+    __m128i chunk = _mm_loadu_si128((const __m128i*)pos);
+    int mask = _mm_movemask_epi8(chunk);
+    return mask == 0 ? 16 : __builtin_ctz(mask);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // Each byte of the comparison is narrowed to 4 bits, so that the first
+    // non-ASCII byte can be found in a single 64-bit value
+    uint8x16_t non_ascii = vcgeq_u8(vld1q_u8(pos), vdupq_n_u8(0x80));
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(non_ascii), 4);
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+    return mask == 0 ? 16 : __builtin_ctzll(mask) / 4;
+#else
+    uint64_t a;
+    uint64_t b;
+    memcpy(&a, pos, 8);
+    memcpy(&b, pos + 8, 8);
+
+    if (((a | b) & 0x8080808080808080ULL) == 0)
+        return 16;
+
+    int count = 0;
+
+    while (pos[count] < 0x80)
+    {
+        count++;
+    }
+
+    return count;
+#endif
+}
+
+uint32_t UTF8Decoder::decodeChar(const unsigned char*& pos,
+                                 const unsigned char* end)
+{
+    unsigned char ch = *pos++;
+
+    if (ch < 0x80)
+        return ch;
+
+    int length = 0;
+    uint32_t codepoint = 0;
+    uint32_t min_value = 0;
+
+    if (ch >= 0xc2 && ch <= 0xdf)
+    {
+        length = 1;
+        codepoint = ch & 0x1f;
+        min_value = 0x80;
+    }
+    else if (ch >= 0xe0 && ch <= 0xef)
+    {
+        length = 2;
+        codepoint = ch & 0x0f;
+        min_value = 0x800;
+    }
+    else if (ch >= 0xf0 && ch <= 0xf4)
+    {
+        length = 3;
+        codepoint = ch & 0x07;
+        min_value = 0x10000;
+    }
+    else
+    {
+        // Stray continuation byte or invalid lead byte
+        return UTF8_REPLACEMENT_CHAR;
+    }
+
+    for (int i = 0; i < length; i++)
+    {
+        if (pos >= end || (*pos & 0xc0) != 0x80)
+            return UTF8_REPLACEMENT_CHAR;
+
+        codepoint = (codepoint << 6) | (*pos++ & 0x3f);
+    }
+
+    if (codepoint < min_value || codepoint > 0x10ffff ||
+        (codepoint >= 0xd800 && codepoint <= 0xdfff))
+        return UTF8_REPLACEMENT_CHAR;
+
+    return codepoint;
+}
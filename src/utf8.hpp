@@ -0,0 +1,90 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef UTF8_HPP
+#define UTF8_HPP
+
+#include <stdint.h>
+#include <string>
+
+#define UTF8_REPLACEMENT_CHAR 0xfffd
+
+// Validating UTF-8 decoder. Invalid or truncated sequences, overlong
+// encodings, surrogates and values above U+10FFFF are decoded as
+// U+FFFD. Runs of ASCII characters are checked 16 bytes at a time when
+// SSE2 or NEON is available.
+class UTF8Decoder
+{
+public:
+    static uint32_t decodeChar(const unsigned char*& pos,
+                               const unsigned char* end);
+    // Returns the number of ASCII characters at the start of the 16 bytes
+    static int countASCII16(const unsigned char* pos);
+};
+
+// Iterates over code points of a UTF-8 string without any allocation. The
+// length of an ASCII run is found once when the run starts, and then its
+// characters are returned without any checks.
+class UTF8Iterator
+{
+private:
+    const unsigned char* m_pos;
+    const unsigned char* m_end;
+    const unsigned char* m_ascii_end;
+
+public:
+    UTF8Iterator(const char* str, int length)
+    {
+        m_pos = (const unsigned char*)str;
+        m_end = m_pos + length;
+        m_ascii_end = m_pos;
+    }
+
+    UTF8Iterator(const std::string& str)
+    {
+        m_pos = (const unsigned char*)str.data();
+        m_end = m_pos + str.size();
+        m_ascii_end = m_pos;
+    }
+
+    bool next(uint32_t& codepoint)
+    {
+        if (m_pos >= m_end)
+            return false;
+
+        if (m_pos < m_ascii_end)
+        {
+            codepoint = *m_pos++;
+            return true;
+        }
+
+        if (*m_pos < 0x80)
+        {
+            if (m_end - m_pos >= 16)
+            {
+                m_ascii_end = m_pos + UTF8Decoder::countASCII16(m_pos);
+            }
+
+            codepoint = *m_pos++;
+            return true;
+        }
+
+        codepoint = UTF8Decoder::decodeChar(m_pos, m_end);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,455 @@
+//    STK Add-ons pack - Simple add-ons installer for Android
+//    Copyright (C) 2017 Dawid Gan <deveee@gmail.com>
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Build-time tool that pre-rasterizes glyphs of the UI fonts into a single
+// grayscale atlas image and writes a binary metrics table for it.
+//
+// Usage:
+//     font_baker [-r first-last[,first-last...]] [-w width] -o output_name
+//                data_dir font_name:size[,size...] ...
+
+#include "font_atlas.hpp"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <png.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct BakeRange
+{
+    unsigned int first;
+    unsigned int last;
+};
+
+struct BakeFont
+{
+    std::string name;
+    std::vector<int> sizes;
+};
+
+struct BakeGlyph
+{
+    FontAtlasGlyph info;
+    std::vector<unsigned char> bitmap;
+};
+
+static std::vector<std::string> splitString(std::string str, char separator)
+{
+    std::vector<std::string> result;
+    std::size_t start = 0;
+
+    while (start <= str.size())
+    {
+        std::size_t pos = str.find(separator, start);
+
+        if (pos == std::string::npos)
+        {
+            pos = str.size();
+        }
+
+        if (pos > start)
+        {
+            result.push_back(str.substr(start, pos - start));
+        }
+
+        start = pos + 1;
+    }
+
+    return result;
+}
+
+static bool parseRanges(std::string arg, std::vector<BakeRange>& ranges)
+{
+    for (std::string range_str : splitString(arg, ','))
+    {
+        BakeRange range;
+        std::size_t pos = range_str.find('-');
+
+        if (pos == std::string::npos)
+        {
+            range.first = strtoul(range_str.c_str(), NULL, 0);
+            range.last = range.first;
+        }
+        else
+        {
+            range.first = strtoul(range_str.substr(0, pos).c_str(), NULL, 0);
+            range.last = strtoul(range_str.substr(pos + 1).c_str(), NULL, 0);
+        }
+
+        if (range.first > range.last || range.last > 0x10ffff)
+        {
+            printf("Error: Invalid glyph range %s\n", range_str.c_str());
+            return false;
+        }
+
+        ranges.push_back(range);
+    }
+
+    return true;
+}
+
+static bool parseFont(std::string arg, std::vector<BakeFont>& fonts)
+{
+    std::size_t pos = arg.find(':');
+
+    if (pos == std::string::npos)
+    {
+        printf("Error: Missing sizes for font %s\n", arg.c_str());
+        return false;
+    }
+
+    BakeFont font;
+    font.name = arg.substr(0, pos);
+
+    if (font.name.size() >= FONT_ATLAS_NAME_LENGTH)
+    {
+        printf("Error: Font name is too long: %s\n", font.name.c_str());
+        return false;
+    }
+
+    for (std::string size_str : splitString(arg.substr(pos + 1), ','))
+    {
+        int size = atoi(size_str.c_str());
+
+        if (size <= 0)
+        {
+            printf("Error: Invalid font size %s\n", size_str.c_str());
+            return false;
+        }
+
+        font.sizes.push_back(size);
+    }
+
+    fonts.push_back(font);
+    return true;
+}
+
+static bool renderFont(FT_Library ft_library, std::string data_dir,
+                       unsigned int font_id, const BakeFont& font,
+                       const std::vector<BakeRange>& ranges,
+                       std::vector<BakeGlyph>& glyphs)
+{
+    std::string path = data_dir + "/" + font.name;
+
+    FT_Face ft_face;
+    int err = FT_New_Face(ft_library, path.c_str(), 0, &ft_face);
+
+    if (err != 0)
+    {
+        printf("Error: Could not create font face for %s\n", path.c_str());
+        return false;
+    }
+
+    FT_Select_Charmap(ft_face, ft_encoding_unicode);
+
+    for (int size : font.sizes)
+    {
+        FT_Set_Pixel_Sizes(ft_face, 0, size);
+        FT_GlyphSlot g = ft_face->glyph;
+
+        for (const BakeRange& range : ranges)
+        {
+            for (unsigned int c = range.first; c <= range.last; c++)
+            {
+                // Characters that are not available in the font are left
+                // for the runtime fallback
+                if (FT_Get_Char_Index(ft_face, c) == 0)
+                    continue;
+
+                if (FT_Load_Char(ft_face, c, FT_LOAD_RENDER))
+                    continue;
+
+                BakeGlyph glyph;
+                memset(&glyph.info, 0, sizeof(glyph.info));
+                glyph.info.font_id = font_id;
+                glyph.info.size = size;
+                glyph.info.codepoint = c;
+                glyph.info.width = g->bitmap.width;
+                glyph.info.height = g->bitmap.rows;
+                glyph.info.left = g->bitmap_left;
+                glyph.info.top = g->bitmap_top;
+                glyph.info.advance = g->advance.x / 64;
+
+                for (unsigned int row = 0; row < g->bitmap.rows; row++)
+                {
+                    unsigned char* src = g->bitmap.buffer +
+                                                        row * g->bitmap.pitch;
+                    glyph.bitmap.insert(glyph.bitmap.end(), src,
+                                        src + g->bitmap.width);
+                }
+
+                glyphs.push_back(glyph);
+            }
+        }
+    }
+
+    FT_Done_Face(ft_face);
+    return true;
+}
+
+static bool packGlyphs(std::vector<BakeGlyph>& glyphs, int width,
+                       int* height, int* used_height)
+{
+    std::vector<BakeGlyph*> sorted;
+
+    for (BakeGlyph& glyph : glyphs)
+    {
+        sorted.push_back(&glyph);
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const BakeGlyph* a, const BakeGlyph* b)
+                     {return a->info.height > b->info.height;});
+
+    for (int atlas_height = 64; atlas_height <= 4096; atlas_height *= 2)
+    {
+        ShelfPacker packer;
+        packer.init(width, atlas_height);
+
+        bool success = true;
+
+        for (BakeGlyph* glyph : sorted)
+        {
+            if (glyph->info.width == 0 || glyph->info.height == 0)
+                continue;
+
+            int x = 0;
+            int y = 0;
+
+            if (!packer.pack(glyph->info.width, glyph->info.height, &x, &y))
+            {
+                success = false;
+                break;
+            }
+
+            glyph->info.x = x;
+            glyph->info.y = y;
+        }
+
+        if (success)
+        {
+            *height = atlas_height;
+            *used_height = packer.getUsedHeight();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool writeAtlasImage(std::string filename, int width, int height,
+                            const std::vector<unsigned char>& pixels)
+{
+    FILE* file = fopen(filename.c_str(), "wb");
+
+    if (file == NULL)
+    {
+        printf("Error: Couldn't open file: %s\n", filename.c_str());
+        return false;
+    }
+
+    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+                                                  NULL, NULL, NULL);
+    png_infop info_ptr = png_ptr ? png_create_info_struct(png_ptr) : NULL;
+
+    if (png_ptr == NULL || info_ptr == NULL)
+    {
+        printf("Error: Couldn't create png write struct\n");
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        fclose(file);
+        return false;
+    }
+
+    png_init_io(png_ptr, file);
+    png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_GRAY,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+                 PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png_ptr, info_ptr);
+
+    for (int i = 0; i < height; i++)
+    {
+        png_write_row(png_ptr, (png_bytep)&pixels[i * width]);
+    }
+
+    png_write_end(png_ptr, NULL);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    fclose(file);
+
+    return true;
+}
+
+static bool writeMetrics(std::string filename, int width, int height,
+                         int used_height, const std::vector<BakeFont>& fonts,
+                         const std::vector<BakeGlyph>& glyphs)
+{
+    FILE* file = fopen(filename.c_str(), "wb");
+
+    if (file == NULL)
+    {
+        printf("Error: Couldn't open file: %s\n", filename.c_str());
+        return false;
+    }
+
+    FontAtlasHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FONT_ATLAS_MAGIC, 4);
+    header.version = FONT_ATLAS_VERSION;
+    header.width = width;
+    header.height = height;
+    header.used_height = used_height;
+    header.fonts_count = fonts.size();
+    header.glyphs_count = glyphs.size();
+
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (const BakeFont& font : fonts)
+    {
+        FontAtlasFont font_info;
+        memset(&font_info, 0, sizeof(font_info));
+        strncpy(font_info.name, font.name.c_str(), FONT_ATLAS_NAME_LENGTH - 1);
+
+        success = success && fwrite(&font_info, sizeof(font_info), 1, file) == 1;
+    }
+
+    for (const BakeGlyph& glyph : glyphs)
+    {
+        success = success &&
+                  fwrite(&glyph.info, sizeof(glyph.info), 1, file) == 1;
+    }
+
+    fclose(file);
+
+    if (!success)
+    {
+        printf("Error: Couldn't write to file: %s\n", filename.c_str());
+    }
+
+    return success;
+}
+
+static void printUsage()
+{
+    printf("Usage: font_baker [-r first-last[,first-last...]] [-w width] "
+           "-o output_name data_dir font_name:size[,size...] ...\n");
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<BakeRange> ranges;
+    std::vector<BakeFont> fonts;
+    std::string output_name;
+    std::string data_dir;
+    int width = 1024;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "-r" && i + 1 < argc)
+        {
+            if (!parseRanges(argv[++i], ranges))
+                return 1;
+        }
+        else if (arg == "-w" && i + 1 < argc)
+        {
+            width = atoi(argv[++i]);
+        }
+        else if (arg == "-o" && i + 1 < argc)
+        {
+            output_name = argv[++i];
+        }
+        else if (data_dir.empty())
+        {
+            data_dir = arg;
+        }
+        else if (!parseFont(arg, fonts))
+        {
+            return 1;
+        }
+    }
+
+    if (output_name.empty() || data_dir.empty() || fonts.empty() ||
+        width <= 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (ranges.empty())
+    {
+        parseRanges("32-126", ranges);
+    }
+
+    FT_Library ft_library;
+
+    if (FT_Init_FreeType(&ft_library) != 0)
+    {
+        printf("Error: Could not initialize freetype library\n");
+        return 1;
+    }
+
+    std::vector<BakeGlyph> glyphs;
+
+    for (unsigned int i = 0; i < fonts.size(); i++)
+    {
+        if (!renderFont(ft_library, data_dir, i, fonts[i], ranges, glyphs))
+        {
+            FT_Done_FreeType(ft_library);
+            return 1;
+        }
+    }
+
+    FT_Done_FreeType(ft_library);
+
+    int height = 0;
+    int used_height = 0;
+
+    if (!packGlyphs(glyphs, width, &height, &used_height))
+    {
+        printf("Error: Glyphs don't fit in the atlas\n");
+        return 1;
+    }
+
+    std::vector<unsigned char> pixels(width * height, 0);
+
+    for (const BakeGlyph& glyph : glyphs)
+    {
+        for (unsigned int row = 0; row < glyph.info.height; row++)
+        {
+            memcpy(&pixels[(glyph.info.y + row) * width + glyph.info.x],
+                   &glyph.bitmap[row * glyph.info.width], glyph.info.width);
+        }
+    }
+
+    if (!writeAtlasImage(output_name + ".png", width, height, pixels))
+        return 1;
+
+    if (!writeMetrics(output_name + ".bin", width, height, used_height, fonts,
+                      glyphs))
+        return 1;
+
+    printf("Baked %u glyphs into %ix%i atlas\n", (unsigned int)glyphs.size(),
+           width, height);
+
+    return 0;
+}